@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// The parameters for the equation to calculate the ADC reading into a physical distance. (see GaussLUT)
+// a = y-stretch, b = x-stretch, c = x-offset, d = y-offset, for more info: https://www.desmos.com/calculator/ps4wd127tu
+struct GaussParameters
+{
+    double a;
+    double b;
+    double c;
+    double d;
+
+    constexpr bool operator==(const GaussParameters &other) const
+    {
+        return a == other.a && b == other.b && c == other.c && d == other.d;
+    }
+};
+
+// The multiplexer channel of Hall Effect keys whose sensor is directly connected to an ADC pin.
+constexpr uint8_t NO_MUX = UINT8_MAX;
+
+// Description of the hardware of a Hall Effect key on the PCB.
+struct HEKeyDescriptor
+{
+    // The ADC pin the sensor, or the multiplexer the sensor is routed through, is connected to.
+    uint8_t pin;
+
+    // The channel of the multiplexer the sensor is connected to, or NO_MUX if it is directly connected to the pin.
+    uint8_t muxChannel;
+
+    // Bool whether the readings of the sensor go up when the key is being pressed down, e.g. because the sensor is mounted the
+    // other way around, resulting in a different polarity. By default, the firmware expects the readings to go down.
+    bool invertReadings;
+
+    // The parameters of the gauss correction for the magnet and sensor combination of the key.
+    GaussParameters gauss;
+};
+
+// Description of the hardware of a digital key on the PCB.
+struct DigitalKeyDescriptor
+{
+    // The pin the digital key is connected to.
+    uint8_t pin;
+};
+
+// Description of the hardware of a keypad. The amount of keys are template parameters so that the key handler can be built specifically
+// for the board, allowing loops to be unrolled and unused code paths (e.g. digital keys on a board without any) to compile away entirely.
+template <uint8_t HEKeyCount, uint8_t DigitalKeyCount, uint8_t MuxSelectPinCount = 0>
+struct BoardDescriptor
+{
+    static constexpr uint8_t heKeyCount = HEKeyCount;
+    static constexpr uint8_t digitalKeyCount = DigitalKeyCount;
+    static constexpr uint8_t muxSelectPinCount = MuxSelectPinCount;
+
+    // By the 4 ADC pins of the RP2040, the amount of Hall Effect keys is limited to 4, unless multiplexers are used.
+    static_assert(HEKeyCount <= 4 || MuxSelectPinCount > 0, "Boards without multiplexers only support up to 4 hall effect keys.");
+    static_assert(HEKeyCount <= 16, "As of right now, the firmware only supports up to 16 hall effect keys.");
+
+    // By the limited amount of ports on the RP2040, the amount of digital keys is limited to 26.
+    static_assert(DigitalKeyCount <= 26, "As of right now, the firmware only supports up to 26 digital keys.");
+
+    // The name of the board, used to identify the selected board variant.
+    const char *name;
+
+    // The descriptors of all Hall Effect and digital keys.
+    std::array<HEKeyDescriptor, HEKeyCount> heKeys;
+    std::array<DigitalKeyDescriptor, DigitalKeyCount> digitalKeys;
+
+    // The pins selecting the channel of the multiplexers, starting with the least significant bit.
+    std::array<uint8_t, MuxSelectPinCount> muxSelectPins;
+};
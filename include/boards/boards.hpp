@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "boards/board_descriptor.hpp"
+#include "definitions.hpp"
+
+// The gauss correction parameters for the hardware of the minipad. (Gateron KS-20 magnets and 49E sensors, see definitions.hpp)
+constexpr GaussParameters MINIPAD_GAUSS_PARAMETERS = {GAUSS_CORRECTION_PARAM_A, GAUSS_CORRECTION_PARAM_B,
+                                                      GAUSS_CORRECTION_PARAM_C, GAUSS_CORRECTION_PARAM_D};
+
+// The board family the firmware is built for is selected via a BOARD_* build flag. A board family consists of one or more variants
+// with the same amount of keys (e.g. different PCB revisions) that are included in the same build. The variant is selected on
+// bootup via the strap pins of the family, which are read as a binary number with a strap to ground representing a 1 bit.
+// The A0 constant is 26 in the RP2040 environment, the pin order of the Hall Effect keys on the minipad is swapped.
+#if defined(BOARD_MINIPAD_2K)
+
+using Board = BoardDescriptor<2, 0>;
+
+inline constexpr Board BOARD_VARIANTS[] = {
+    {"minipad-2k",
+     {{{A0 + 1, NO_MUX, false, MINIPAD_GAUSS_PARAMETERS},
+       {A0 + 0, NO_MUX, false, MINIPAD_GAUSS_PARAMETERS}}},
+     {},
+     {}},
+};
+
+inline constexpr std::array<uint8_t, 0> BOARD_STRAP_PINS = {};
+
+#elif defined(BOARD_MINIPAD_3K)
+
+using Board = BoardDescriptor<3, 0>;
+
+inline constexpr Board BOARD_VARIANTS[] = {
+    {"minipad-3k",
+     {{{A0 + 2, NO_MUX, false, MINIPAD_GAUSS_PARAMETERS},
+       {A0 + 1, NO_MUX, false, MINIPAD_GAUSS_PARAMETERS},
+       {A0 + 0, NO_MUX, false, MINIPAD_GAUSS_PARAMETERS}}},
+     {},
+     {}},
+};
+
+inline constexpr std::array<uint8_t, 0> BOARD_STRAP_PINS = {};
+
+#else
+#error No board has been specified. Please add one of the BOARD_* flags to the build flags of the environment.
+#endif
+
+// Returns the variant of the board family the firmware is running on, as selected by the strap pins.
+const Board &selectBoard();
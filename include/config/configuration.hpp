@@ -2,6 +2,9 @@
 
 #include "config/keys/he_key_config.hpp"
 #include "config/keys/digital_key_config.hpp"
+#include "config/socd_group.hpp"
+#include "boards/boards.hpp"
+#include "definitions.hpp"
 
 // Configuration for the whole firmware, containing the name of the keypad and it's configurations.
 struct Configuration
@@ -12,17 +15,45 @@ struct Configuration
     // The name of the keypad, used to distinguish it from others.
     char name[128] = "minipad";
 
+    // The time in milliseconds without any motion on the keypad after which it becomes idle. 0 disables the idle mode.
+    uint32_t idleTimeout = IDLE_TIMEOUT;
+
+    // The threshold in milliseconds below which a press is counted as chatter in the statistics of a key.
+    uint16_t chatterThreshold = CHATTER_THRESHOLD;
+
+    // The interval in minutes in which the statistics of the keys are checkpointed to the EEPROM. 0 disables the checkpoints.
+    uint16_t statisticsCheckpointInterval = 0;
+
+    // The deadline of a single iteration of the main loop in microseconds, above which it is captured as an overrun. 0 disables the capture.
+    uint16_t loopDeadline = LOOP_DEADLINE_US;
+
+    // Bool whether the travel distance of the Hall Effect keys is sent as the axes of a gamepad, next to the keyboard.
+    bool gamepadOutput = false;
+
+    // The response curve of the gamepad axes as the exponent in percent (100 = linear, 200 = quadratic, 50 = square root).
+    uint16_t gamepadCurve = 100;
+
+    // The deadzone at the top of the travel distance of the gamepad axes, in 0.01mm.
+    uint16_t gamepadDeadzone = GAMEPAD_DEADZONE;
+
     // A list of all hall effect key configurations. (rapid trigger, hysteresis, calibration, ...)
-    HEKeyConfig heKeys[HE_KEYS];
+    HEKeyConfig heKeys[Board::heKeyCount];
 
     // A list of all digital key configurations. (key char, hid state, ...)
-    DigitalKeyConfig digitalKeys[DIGITAL_KEYS];
+    DigitalKeyConfig digitalKeys[Board::digitalKeyCount];
+
+    // A list of all groups of Hall Effect keys with SOCD resolution.
+    SOCDGroup socdGroups[SOCD_GROUPS];
+
+    // The crosstalk matrix of the Hall Effect keys in Q15 fixed-point, with the shift of the reading of the key in the row per deflection
+    // of the key in the column. (see CrosstalkCalibrator) Measured via the crosstalk calibration, all zeros disable the compensation.
+    int16_t crosstalk[Board::heKeyCount][Board::heKeyCount] = {};
 
     // Returns the version constant of the latest Configuration layout.
     static uint32_t getVersion()
     {
         // Version of the configuration in the format YYMMDDhhmm (e.g. 2301030040 for 12:44am on the 3rd january 2023)
-        int64_t version = 2308161815;
+        int64_t version = 2610192330;
 
         return version;
     }
@@ -29,12 +29,12 @@ private:
 
         // Populate the Hall Effect keys array with the correct amount of Hall Effect keys.
         // Assign the key char from z downwards (z, y, x, w, v, ...). After 26 keys, stick to an 'a' key to not overflow.
-        for (uint8_t i = 0; i < HE_KEYS; i++)
+        for (uint8_t i = 0; i < Board::heKeyCount; i++)
             config.heKeys[i] = HEKeyConfig(i >= 26 ? 'a' : (char)('z' - i));
 
         // Populate the digital keys array with the correct amount of digital keys.
     // Assign the key char from a forwards (a, b, c, d, e, ...). After 26 keys, stick to an 'z' key to not overflow.
-        for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+        for (uint8_t i = 0; i < Board::digitalKeyCount; i++)
             config.digitalKeys[i] = DigitalKeyConfig(i >= 26 ? 'z' : (char)('a' + i));
 
         return config;
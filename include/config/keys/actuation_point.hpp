@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// The actions that can be performed when a Hall Effect key crosses one of its actuation points.
+enum class ActuationAction : uint8_t
+{
+    // Do nothing.
+    None = 0,
+
+    // Press the key char of the actuation point and hold it until it is released by another action.
+    Press = 1,
+
+    // Release the key char of the actuation point.
+    Release = 2,
+
+    // Press the key char of the actuation point and release it on the next report.
+    Tap = 3
+};
+
+// Configuration for an additional actuation point of a Hall Effect key, with its own key char and actions.
+struct ActuationPoint
+{
+    // The distance at which the actuation point is crossed. The unit of the value is 0.01mm.
+    uint16_t distance = 0;
+
+    // The key char the actions are performed with. The actuation point is disabled if this is zero.
+    char keyChar = '\0';
+
+    // The action performed when the key crosses the actuation point downwards.
+    ActuationAction pressAction = ActuationAction::None;
+
+    // The action performed when the key crosses the actuation point upwards.
+    ActuationAction releaseAction = ActuationAction::None;
+};
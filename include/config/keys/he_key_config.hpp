@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include "config/keys/key_config.hpp"
+#include "config/keys/actuation_point.hpp"
 #include "definitions.hpp"
 
 // Configuration for the Hall Effect keys of the keypad, containing the actuation points, calibration, sensitivities etc. of the key.
@@ -30,4 +31,33 @@ struct HEKeyConfig : KeyConfig
 
     // The value below which the key is no longer pressed and rapid trigger is no longer active in rapid trigger mode.
     uint16_t upperHysteresis = (uint16_t)(TRAVEL_DISTANCE_IN_0_01MM * 0.675);
+
+    // The deadzone applied to the rest and down position on boundary updates, in counts of the sensor resolution.
+    uint16_t sensorBoundaryDeadzone = SENSOR_BOUNDARY_DEADZONE;
+
+    // The exponent for the amount of samples in the burst of every reading of this key.
+    uint8_t oversamplingExponent = OVERSAMPLING_EXPONENT;
+
+    // The exponent for the amount of samples of the SMA filter of this key.
+    uint8_t smaFilterSampleExponent = SMA_FILTER_SAMPLE_EXPONENT;
+
+    // The minimum value for the rapid trigger sensitivities of this key.
+    uint16_t rapidTriggerTolerance = RAPID_TRIGGER_TOLERANCE;
+
+    // Bool whether the rest and down position are continuously tracked to compensate for drift, instead of only ever being widened.
+    bool driftTracking = true;
+
+    // Bool whether the gauss correction uses the curve fitted to this key by a gauss calibration instead of the one of the board.
+    bool customGauss = false;
+
+    // The parameters a, b, c and d of the gauss correction curve fitted to this key by a gauss calibration. (see GaussParameters)
+    // These are stored as floats to save space in the EEPROM, which is still plenty of precision for the lookup table.
+    float gaussParameters[4] = {0};
+
+    // The distance below which a tap-hold key performs the hold right away, without waiting for the hold time. 0 disables this.
+    // The unit of the value is 0.01mm.
+    uint16_t holdDistance = 0;
+
+    // The additional actuation points of the key. If at least one is enabled, they replace the hysteresis and rapid trigger logic.
+    ActuationPoint actuationPoints[ACTUATION_POINTS];
 };
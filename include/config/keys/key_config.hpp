@@ -1,6 +1,23 @@
 #pragma once
 
 #include <cstdint>
+#include "definitions.hpp"
+
+// The modes of a key, determining what happens when it is pressed.
+enum class KeyMode : uint8_t
+{
+    // Send the key char of the active layer.
+    Normal = 0,
+
+    // Send the key char of the active layer when tapped, or the hold key char (or switch to the layer of the key) when held past the hold time.
+    TapHold = 1,
+
+    // Switch to the layer of the key while it is held down.
+    MomentaryLayer = 2,
+
+    // Switch to the layer of the key on a press, and back on the next press.
+    ToggleLayer = 3
+};
 
 // The base configuration struct for the DigitalKeyConfig and HEKeyConfig struct, containing the common fields.
 struct KeyConfig
@@ -13,4 +30,19 @@ struct KeyConfig
 
     // Bools whether HID commands are sent on the key.
     bool hidEnabled = false;
+
+    // The mode of the key. (see KeyMode)
+    KeyMode mode = KeyMode::Normal;
+
+    // The layer switched to by the layer modes, and by the tap-hold mode when held if no hold key char is set.
+    uint8_t layer = 1;
+
+    // The key char sent when a tap-hold key is held. If zero, holding the key switches to its layer instead.
+    char holdKeyChar = '\0';
+
+    // The time in milliseconds a tap-hold key has to be held down to perform the hold instead of the tap.
+    uint16_t holdTime = TAP_HOLD_TIME;
+
+    // The key chars of the key on the layers above the base layer. If zero, the key char of the next lower layer is used.
+    char layerKeyChars[LAYERS - 1] = {0};
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// The modes for resolving simultaneous opposing cardinal directions (SOCD), meaning multiple keys of a group being pressed at once.
+enum class SOCDMode : uint8_t
+{
+    // The group is disabled, all keys are sent as they are pressed.
+    Off = 0,
+
+    // Only the key that was pressed last is sent.
+    LastInput = 1,
+
+    // Only the key that was pressed first is sent.
+    FirstInput = 2,
+
+    // None of the keys are sent while more than one is pressed.
+    Neutral = 3,
+
+    // Only the Hall Effect key that is pressed down the furthest is sent.
+    DeepestTravel = 4
+};
+
+// Configuration for a group of Hall Effect keys of which only one is sent at a time, resolved by the specified mode.
+struct SOCDGroup
+{
+    // The Hall Effect keys in the group as a bitmask, with the least significant bit being the first key.
+    uint16_t keys = 0;
+
+    // The mode for resolving multiple keys of the group being pressed at once.
+    SOCDMode mode = SOCDMode::Off;
+};
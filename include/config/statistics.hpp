@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include "boards/boards.hpp"
+#include "definitions.hpp"
+
+// The actuation statistics of a single key, used to spot worn or noisy switches and unintended re-triggers.
+struct KeyStatistics
+{
+    // The amount of presses and releases of the key.
+    uint32_t presses = 0;
+    uint32_t releases = 0;
+
+    // The amount of presses caused by the rapid trigger logic while the key was already inside the rapid trigger zone.
+    uint32_t rapidTriggers = 0;
+
+    // The amount of times the key left the rapid trigger zone by being fully released with continuous rapid trigger enabled.
+    uint32_t continuousRapidTriggerResets = 0;
+
+    // The amount of presses shorter than the configured chatter threshold.
+    uint32_t chatters = 0;
+
+    // The histogram of the press durations. Bucket n counts the presses lasting from 2^n to 2^(n+1) milliseconds,
+    // except for the first one also counting shorter presses and the last one also counting longer presses.
+    uint32_t durations[KEY_STATISTICS_DURATION_BUCKETS] = {0};
+};
+
+// The actuation statistics of all keys, checkpointed to the EEPROM behind the configuration.
+struct Statistics
+{
+    // Version of the statistics, used to check whether the struct layout in the EEPROM is up-to-date.
+    uint32_t version = Statistics::getVersion();
+
+    // The statistics of all Hall Effect and digital keys.
+    KeyStatistics heKeys[Board::heKeyCount];
+    KeyStatistics digitalKeys[Board::digitalKeyCount];
+
+    // Returns the version constant of the latest Statistics layout.
+    static uint32_t getVersion()
+    {
+        // Version of the statistics in the format YYMMDDhhmm (e.g. 2301030040 for 12:44am on the 3rd january 2023)
+        int64_t version = 2610192000;
+
+        return version;
+    }
+};
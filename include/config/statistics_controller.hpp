@@ -0,0 +1,19 @@
+#pragma once
+
+#include "config/statistics.hpp"
+#include "definitions.hpp"
+
+inline class StatisticsController
+{
+public:
+    void loadStatistics();
+    void saveStatistics();
+    void resetStatistics();
+    void handle(bool idle);
+
+    Statistics statistics;
+
+private:
+    // The last time the statistics were checkpointed to the EEPROM, in milliseconds since firmware bootup.
+    unsigned long lastCheckpoint = 0;
+} StatisticsController;
@@ -18,8 +18,9 @@
 // possibly get stuck if you press the key down but happen to not be able to get back up enough.
 #define HYSTERESIS_TOLERANCE 10
 
-// The minimum value for the rapid trigger sensitivities. This is important to not have the key continuously
+// The default minimum value for the rapid trigger sensitivities. This is important to not have the key continuously
 // continuously actuate if you do very very slight movements or if the fluctuation is simply too high.
+// This value is configured per key and can be tightened by the auto-tuning based on the noise measured on the key.
 #define RAPID_TRIGGER_TOLERANCE 10
 
 // The threshold when a key is considered fully released. 10 would mean if the key is <0.1mm pressed.
@@ -30,11 +31,30 @@
 // to introduce a deadzone at the boundaries. This might be desired since values might fluctuate.
 // e.g. if the value fluctuates around 1970 in rest position but peaks at 1975, this would counteract it.
 // 10 may seem like much at first but when "smashing" the button a lot it'll be just right.
-#define SENSOR_BOUNDARY_DEADZONE 10
+// This is the default value in 12-bit ADC counts, scaled to the sensor resolution. The deadzone is configured
+// per key in counts of the sensor resolution and can be tightened by the auto-tuning.
+#define SENSOR_BOUNDARY_DEADZONE (10 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION))
+
+// The exponent for the time constant of the drift tracking in milliseconds. While a key is resting or fully pressed, the envelope
+// of the readings decays towards the current readings by 1/2^n per millisecond, so 10 results in a time constant of ~1 second.
+// This has to be fast enough to follow temperature drift but slow enough to not follow the fluctuation of the readings.
+#define DRIFT_TRACKING_DECAY_EXPONENT 10
+
+// The amount of consecutive readings beyond the deadzone of the tracked envelope after which they are no longer
+// rejected as outliers but considered an actual change of the rest or down position.
+#define DRIFT_TRACKING_OUTLIER_SAMPLES 64
+
+// The distance below which a key is considered fully pressed for the drift tracking of the down position. This is
+// a bit bigger than the threshold for a full release since a drifted down position might not be reached anymore.
+#define DRIFT_TRACKING_DOWN_THRESHOLD 20
+
+// The minimum difference between the tracked and the current rest or down position for a recalibration to happen.
+// This prevents the boundaries from constantly flipping between two values due to rounding. (2 12-bit ADC counts)
+#define DRIFT_TRACKING_HYSTERESIS (2 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION))
 
 // The minimum difference between the rest position and the deadzone-applied down position.
-// It is important to mantain a minimum analog range to prevent "crazy behavior".
-#define SENSOR_BOUNDARY_MIN_DISTANCE 200
+// It is important to mantain a minimum analog range to prevent "crazy behavior". (200 12-bit ADC counts)
+#define SENSOR_BOUNDARY_MIN_DISTANCE (200 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION))
 
 // Flag for enabling gauss correction. This improves the accuracy of the sensor readings by correcting the curve of
 // the relation between the magnetic field strength near the sensor and the distance of the magnet from the sensor.
@@ -52,54 +72,218 @@
 #define GAUSS_CORRECTION_PARAM_C -721.743991123
 #define GAUSS_CORRECTION_PARAM_D 4525.58542876
 
+// The amount of evenly spaced ADC levels between the rest and the down position whose crossings are recorded during a gauss calibration.
+#define GAUSS_CALIBRATION_LEVELS 64
+
+// The minimum duration of the sweep of a gauss calibration in milliseconds. The key has to be pressed down slowly and steadily,
+// since the filter and the sample rate smear the crossings of the levels on a fast sweep, distorting the fitted curve.
+#define GAUSS_CALIBRATION_MIN_SWEEP_TIME 500
+
+// The time in milliseconds after which a gauss calibration is aborted if the sweep has not been completed.
+#define GAUSS_CALIBRATION_TIMEOUT 30000
+
+// The amount of curvature candidates evaluated by the gauss calibration, in steps of 1/16 over the full travel distance.
+// One candidate is evaluated per scan pass, so this bounds both the range of curvatures that can be fitted and the time it takes.
+#define GAUSS_FIT_CURVATURE_STEPS 80
+
+// The amount of entries of a gauss correction lookup table calculated per scan pass when it is rebuilt at runtime, e.g. after a gauss
+// calibration. This keeps the scans of the keys going while the table is rebuilt, which would otherwise stall them for a while.
+#define GAUSS_LUT_BUILD_CHUNK_SIZE 16
+
+// The amount of gauss correction lookup tables shared by the Hall Effect keys, each taking up 8 KB of memory. Keys with the same curve
+// share a table, so this is the amount of distinct curves in use at once: the one of the board plus the ones of gauss calibrations.
+// Keys with a curve beyond this amount fall back to the linear mapping.
+#define GAUSS_LUT_SLOTS 3
+
 // The resolution for the ADCs on the RP2040. The theoretical maximum value on it is 16 bit (uint16_t).
 #define ANALOG_RESOLUTION 12
 
+// The effective resolution of the sensor readings after oversampling. Every reading of a Hall Effect key is a burst of samples decimated
+// into this resolution, which is what the filter, the calibration and the gauss correction work with. With a rest-to-down range of only
+// a few hundred 12-bit counts, the extra bits make the distance steps finer than the 0.01mm unit, allowing tighter rapid trigger sensitivities.
+#define SENSOR_RESOLUTION 14
+
+// The default exponent for the amount of samples in the burst of every reading of a Hall Effect key. Every sample takes 2µs,
+// so longer bursts increase the effective resolution at the cost of the scan rate. 0 = 1 sample, 1 = 2 samples, 2 = 4 samples, ...
+// The exponent is configured per key, up to OVERSAMPLING_MAX_EXPONENT.
+#define OVERSAMPLING_EXPONENT 2
+
+// The maximum exponent for the amount of samples in the burst of every reading of a Hall Effect key.
+#define OVERSAMPLING_MAX_EXPONENT 6
+
+// The size of the emulated EEPROM in bytes, holding the configuration and the statistics behind it.
+#define EEPROM_SIZE 1024
+
 // The buffer size of any serial input. Defined here for consistent use across the serial handler and avoiding of magic numbers.
 #define SERIAL_INPUT_BUFFER_SIZE 1024
 
-// The exponent for the amount of samples for the SMA filter. This filter reduces fluctuation of analog values.
-// A value too high may cause unresponsiveness. 1 = 1 sample, 2 = 4 samples, 3 = 8 samples, 4 = 16 samples, ...
+// The default exponent for the amount of samples for the SMA filter. This filter reduces fluctuation of analog values.
+// A value too high may cause unresponsiveness. 0 = 1 sample, 1 = 2 samples, 2 = 4 samples, 3 = 8 samples, 4 = 16 samples, ...
+// The exponent is configured per key and may be lowered or raised by the auto-tuning, up to SMA_FILTER_MAX_SAMPLE_EXPONENT.
 #define SMA_FILTER_SAMPLE_EXPONENT 4
 
+// The maximum exponent for the amount of samples for the SMA filter. The buffer of every filter is sized for this amount.
+#define SMA_FILTER_MAX_SAMPLE_EXPONENT 6
+
+// The exponent for the amount of samples in one noise statistics window. The noise of every key is measured
+// over windows of 2^n consecutive samples taken while the key is resting, discarding a window if the key moves.
+#define NOISE_STATS_WINDOW_EXPONENT 12
+
+// The target standard deviation of the filtered sensor readings for the auto-tuning, in 0.01 12-bit ADC counts scaled to the sensor
+// resolution. The auto-tuning picks the smallest SMA filter depth that brings the noise measured on the key below this value.
+#define AUTO_TUNE_TARGET_NOISE (50 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION))
+
+// The amount of standard deviations the filtered readings are expected to fluctuate in (peak-to-peak) at rest.
+// 6 sigma cover 99.7% of the samples, the rare ones outside of it are caught by the safety margin below.
+#define AUTO_TUNE_NOISE_SIGMAS 6
+
+// The factor applied to the measured noise when deriving the minimum rapid trigger sensitivity. The mapping of the
+// noise to a distance is only linearly approximated, which underestimates it near the rest position.
+#define AUTO_TUNE_SAFETY_FACTOR 2
+
+// The lowest minimum rapid trigger sensitivity the auto-tuning is allowed to derive for a key.
+#define AUTO_TUNE_MIN_RAPID_TRIGGER_TOLERANCE 2
+
 // The travel distance of the switches, where 1 unit equals 0.01mm. This is used to map the values properly to
 // guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
 #define TRAVEL_DISTANCE_IN_0_01MM 400
 
-// Uncomment this line if the sensor readings go up when the key is being pressed down.
-// By default, the firmware is made to handle the readings going down and not up.
-// #define INVERT_SENSOR_READINGS
+// The maximum amount of additional actuation points per Hall Effect key. They are evaluated on every sample
+// of a key, so this bounds the time spent on them, keeping the evaluation constant-time per key.
+#define ACTUATION_POINTS 4
+
+// The maximum amount of SOCD groups, each consisting of multiple Hall Effect keys of which only one is sent at a time.
+#define SOCD_GROUPS 4
+
+// The amount of axes of the gamepad output. The travel distance of the first Hall Effect keys is sent on the X, Y, Z, Z rotation and slider axes.
+#define GAMEPAD_AXES 6
+
+// The default deadzone at the top of the travel distance of the gamepad output, in which the axes stay at their lowest value.
+// This keeps the axes from fluctuating while the keys are resting. The unit of the value is 0.01mm.
+#define GAMEPAD_DEADZONE 10
+
+// The lowest and highest response curve of the gamepad axes that can be configured, as the exponent in percent.
+#define GAMEPAD_MIN_CURVE 25
+#define GAMEPAD_MAX_CURVE 400
+
+// The maximum amount of edges (presses and releases) queued per key char for the HID report. Every report contains at most one edge per
+// key char, so transitions faster than the polling rate are sent over consecutive reports instead of being dropped.
+#define KEY_OUTPUT_QUEUE_SIZE 4
+
+// The maximum amount of records of the latency beacon per HID report. Every edge in a report produces one record, so this only
+// limits reports in which more key chars change at once, dropping the records of the additional edges.
+#define LATENCY_BEACON_CAPACITY 16
+
+// The maximum length of a record of the latency beacon on the serial interface, including the newline and null terminator.
+// Seven numbers of at most 10 digits each, separated by spaces and prefixed with "LAT", fit into this length.
+#define LATENCY_RECORD_MAX_LENGTH 84
+
+// The amount of layers of the key chars, including the base layer. Every key has a key char per layer above the base one, which
+// is used instead of its key char while that layer is active. The layers are switched via the momentary and toggle layer keys.
+#define LAYERS 4
+
+// The default time in milliseconds a tap-hold key has to be held down to perform the hold instead of the tap.
+#define TAP_HOLD_TIME 200
 
 // The delay for the debounce on digital keys. This is necessary because the contacts on digital buttons "bounce",
 // meaning instead of a steady HIGH signal you'll get a couple signal changes (e.g. HIGH LOW HIGH LOW HIGH)
 // This millisecond delay is the minimum time between button presses for the HID signal to send to the host device.
 #define DIGITAL_DEBOUNCE_DELAY 50
 
-// Macro for getting the hall effect sensor pin of the specified key index. The pin order is being swapped here,
-// meaning on a 3-key device the pins are 28, 27 and 26. This macro has to be adjusted, depending on how the PCB
-// and hardware of the device using this firmware has been designed. The A0 constant is 26 in the RP2040 environment.
-// NOTE: By the uint8 datatype, the amount of keys is limited to 255.
-// NOTE: By the RP2040, the amount of analog pins (and therefore keys) is limited o 4.
-#define HE_PIN(index) A0 + HE_KEYS - index - 1
-
-// Macro for getting the pin of the specified index of the digital key. The pin order is not swapped here, meaning
-// the first digital key is on pin 0, the second on 1, and so on.
-// NOTE: This way, the amount of keys is limited to 26 since the 27th key overlaps with the first analog port, 26.
-#define DIGITAL_PIN(index) 0 + DIGITAL_KEYS - index - 1
-
-// Add a compiler error if the firmware is being tried to built with more than the supported 4 keys.
-// (only 4 ADC pins available)
-#if HE_KEYS > 4
-#error As of right now, the firmware only supports up to 4 hall effect keys.
-#endif
+// The default threshold in milliseconds below which a press is counted as chatter in the statistics of a key. Presses this short are
+// not humanly possible, so they indicate a bouncing switch or a noisy sensor rather than an actual press.
+#define CHATTER_THRESHOLD 5
 
-// Add a compiler error if the firmware is being tried to built with more than the supported 26 digital keys.
-// (limited amount of ports)
-#if DIGITAL_KEYS > 26
-#error As of right now, the firmware only supports up to 26 digital keys.
-#endif
+// The amount of buckets of the histogram of the press durations of every key. The buckets are spaced logarithmically,
+// starting at 2ms, so 10 buckets cover presses up to 512ms, with longer presses being counted in the last bucket.
+#define KEY_STATISTICS_DURATION_BUCKETS 10
+
+// The minimum interval in minutes in which the statistics of the keys can be checkpointed to the EEPROM. Every checkpoint erases
+// and rewrites a sector of the flash, which only lasts for around 100k cycles, so this keeps it alive for over a decade.
+#define STATISTICS_MIN_CHECKPOINT_INTERVAL 60
+
+// The amount of passes after which a resting Hall Effect key is sampled again while other keys are active. Resting keys
+// are skipped in favor of extra samples for active keys, but are guaranteed to be sampled at least at 1/n of the full rate.
+#define SCAN_RESTING_KEY_INTERVAL 4
+
+// The distance to the lower or upper hysteresis below which a Hall Effect key is considered active for the scheduling
+// of the samples, since this is where the next sample may cause an actuation. The unit of the value is 0.01mm.
+#define SCAN_PRIORITY_THRESHOLD_DISTANCE 20
+
+// The default time in milliseconds without any motion on the keypad after which it becomes idle and the scan rate is lowered.
+#define IDLE_TIMEOUT 10000
+
+// The time in microseconds to sleep between two scans while the keypad is idle. The interval plus the time of one scan is the
+// worst-case latency for the first press after being idle, which has to stay below one USB frame (1ms) to not be noticeable.
+#define IDLE_SCAN_INTERVAL_US 500
+
+// The default deadline of a single iteration of the main loop in microseconds. Iterations taking longer are counted as overruns and a
+// snapshot of them is kept, since a single stalled iteration can delay or swallow a tap even if the average scan rate looks fine.
+// The time slept while the keypad is idle is not counted towards the iteration. 0 disables the capture of overruns.
+#define LOOP_DEADLINE_US 1000
+
+// The amount of snapshots of the worst loop overruns kept by the deadline monitor. Once all are taken, a new overrun only replaces
+// the shortest snapshot if it took longer, so the longest stalls since the last reset are kept.
+#define DEADLINE_SNAPSHOTS 8
+
+// The time in microseconds to wait after switching the channel of a multiplexer before reading the sensor routed through it.
+// This gives the output of the multiplexer and the sample capacitor of the ADC time to settle on the new signal.
+#define MUX_SETTLE_TIME_US 2
+
+// The maximum amount of Hall Effect keys supported by the crosstalk compensation. The compensation of every sample sums up the coupling of all
+// other keys, which has to fit into 32 bits with the maximum coefficient and deflection. (see CROSSTALK_MAX_COEFFICIENT)
+#define CROSSTALK_MAX_KEYS 16
+
+// The maximum absolute coefficient of the crosstalk between two Hall Effect keys in Q15 fixed-point (8192 = 0.25). Real crosstalk is
+// in the range of a few percent, so this only bounds the outliers of a bad calibration, which keeps the sum of up to 15 neighbouring
+// keys deflected over the full sensor resolution within 32 bits.
+#define CROSSTALK_MAX_COEFFICIENT 8192
+
+// The time in milliseconds after which a crosstalk calibration is aborted if not every key has been pressed down fully once.
+#define CROSSTALK_CALIBRATION_TIMEOUT 60000
+
+// The distance below which a key counts as clearly pressed during a crosstalk calibration, in 0.01mm. Only samples in which exactly one
+// key is pressed this far are recorded. This is far beyond the shift the crosstalk causes on the resting keys, so that the strongest
+// couplings are not mistaken for a second key being pressed.
+#define CROSSTALK_PRESSED_DISTANCE 200
+
+// The default interval between two samples of the profiler in microseconds. This is deliberately not a divisor of the 1ms USB frame,
+// so the samples do not lock onto the same phase of periodic work (e.g. the USB interrupts) and are spread over the whole firmware.
+#define PROFILER_INTERVAL_US 97
+
+// The minimum interval between two samples of the profiler in microseconds, to leave the firmware enough time between the interrupts.
+#define PROFILER_MIN_INTERVAL_US 20
+
+// The size of the code covered by one bucket of the histogram of the profiler in bytes. Must be a power of two.
+#define PROFILER_BUCKET_SIZE 16
+
+// The exponent for the amount of buckets of the histogram of the profiler. 9 = 512 buckets, taking up 4KB of memory.
+#define PROFILER_BUCKETS_EXPONENT 9
 
 // If the debug flag is not set via compiler parameters, default it to 0 since it's required for if statements.
 #ifndef DEV
 #define DEV 0
 #endif
+
+// The levels of the binary logger. Log calls above the compiled LOG_LEVEL are removed entirely, including their format strings.
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// If the log level is not set via compiler parameters, default it to debug in development environments and to warnings otherwise.
+#ifndef LOG_LEVEL
+#if DEV
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#else
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+#endif
+
+// The size of the ring buffer of the binary logger in 32-bit words. Must be a power of two. Every record takes up two words plus one word
+// per argument, so 1024 words (4KB) hold a few hundred records between two drains via the 'log' command.
+#define LOG_BUFFER_SIZE 1024
+
+// The maximum amount of arguments of a single log call.
+#define LOG_MAX_ARGUMENTS 6
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+
+inline class GamepadHandler
+{
+public:
+    void begin();
+    void updateResponseCurve();
+    void handle();
+
+private:
+    // The axis value for every travel distance of a key, with the response curve and deadzone of the configuration applied.
+    // This is precomputed whenever the configuration changes to keep the conversion on every pass a single lookup.
+    int16_t responseCurve[TRAVEL_DISTANCE_IN_0_01MM + 1] = {0};
+
+    // The axis values sent with the last report, used to only send a report if any axis changed. Axes beyond the amount of
+    // Hall Effect keys stay at 0.
+    int16_t axes[GAMEPAD_AXES] = {0};
+} GamepadHandler;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+
+inline class IdleHandler
+{
+public:
+    void handle(bool motionDetected);
+
+    // Bool whether the keypad is currently idle, meaning the scans are slowed down.
+    bool idle = false;
+
+    // The amount of times the keypad woke up from being idle.
+    uint32_t wakes = 0;
+
+    // The highest time between the last scan before motion was detected and the detection itself, in microseconds.
+    // This is the worst-case latency added by the keypad being idle.
+    uint32_t maxWakeLatency = 0;
+
+    // Returns the total time the keypad has spent being idle, in milliseconds.
+    uint32_t getIdleTime() const;
+
+    // Returns whether the keypad is idle or, if the idle mode is disabled, no motion has been detected for the default idle timeout.
+    // This is used for work that stalls the firmware and should only happen while nobody is playing, even without the idle mode.
+    bool isQuiet() const;
+
+private:
+    // The total time the keypad has spent being idle, not including the current idle period, in milliseconds.
+    uint32_t idleTime = 0;
+
+    // The last time motion was detected and the time the current idle period started, in milliseconds since firmware bootup.
+    unsigned long lastMotion = 0;
+    unsigned long idleSince = 0;
+
+    // The time the last scan ended, in microseconds since firmware bootup.
+    unsigned long lastScan = 0;
+} IdleHandler;
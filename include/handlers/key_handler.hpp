@@ -1,41 +1,132 @@
 #pragma once
 #pragma GCC diagnostic ignored "-Wtype-limits"
 
+#include <array>
 #include "config/configuration_controller.hpp"
+#include "config/statistics_controller.hpp"
+#include "boards/boards.hpp"
 #include "handlers/keys/he_key.hpp"
 #include "handlers/keys/digital_key.hpp"
 #include "helpers/sma_filter.hpp"
 #include "helpers/gauss_lut.hpp"
+#include "helpers/gauss_fitter.hpp"
+#include "helpers/crosstalk_calibrator.hpp"
+#include "helpers/event_scheduler.hpp"
 #include "definitions.hpp"
 
-inline class KeyHandler
+// The key handler is built for the board family specified by the TBoard descriptor type. This way, the amount of keys is known
+// at compile-time, allowing the loops over the keys to be unrolled and unused code paths to compile away entirely.
+template <typename TBoard>
+class BasicKeyHandler
 {
 public:
-    KeyHandler()
+    BasicKeyHandler()
     {
-        // Assign indicies and their corresponding HEKeyConfig to all Hall Effect keys.
-        for (uint8_t i = 0; i < HE_KEYS; i++)
-            heKeys[i] = HEKey(i, &ConfigController.config.heKeys[i]);
+        // Assign indicies and their corresponding HEKeyConfig and KeyStatistics to all Hall Effect keys.
+        for (uint8_t i = 0; i < TBoard::heKeyCount; i++)
+            heKeys[i] = HEKey(i, &ConfigController.config.heKeys[i], &StatisticsController.statistics.heKeys[i]);
 
-        // Assign indicies and their corresponding DigitalKeyConfig to all digital keys.
-        for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
-            digitalKeys[i] = DigitalKey(i, &ConfigController.config.digitalKeys[i]);
+        // Assign indicies and their corresponding DigitalKeyConfig and KeyStatistics to all digital keys.
+        for (uint8_t i = 0; i < TBoard::digitalKeyCount; i++)
+            digitalKeys[i] = DigitalKey(i, &ConfigController.config.digitalKeys[i], &StatisticsController.statistics.digitalKeys[i]);
     }
 
+    void begin(const TBoard &board);
     void handle();
+    bool autoTune(HEKey &key);
+    void updateActuationPoints(HEKey &key);
     bool outputMode;
-    HEKey heKeys[HE_KEYS];
-    DigitalKey digitalKeys[DIGITAL_KEYS];
+
+#ifdef USE_GAUSS_CORRECTION_LUT
+    bool startGaussCalibration(HEKey &key);
+    void resetGaussCalibration(HEKey &key);
+    GaussParameters getGaussParameters(const HEKey &key);
+
+    // The gauss calibration of the Hall Effect keys. Only one key can be calibrated at a time.
+    GaussFitter gaussFitter;
+#endif
+
+    bool startCrosstalkCalibration();
+    void resetCrosstalkCalibration();
+
+    // The crosstalk calibration of the Hall Effect keys.
+    CrosstalkCalibrator crosstalkCalibrator;
+
+    // The amount of edges (presses and releases) that had to wait for an earlier edge of the same key char to be sent first,
+    // and the amount of edges dropped in pairs because the queue of the key char was full.
+    uint32_t delayedEdges = 0;
+    uint32_t coalescedEdges = 0;
+
+    // The layer the key chars are currently taken from. This is the highest layer that is held or toggled on, or 0 for the base layer.
+    uint8_t activeLayer = 0;
+
+    // Bool whether motion has been detected on any key during the last handle() call, meaning a sensor reading left its
+    // noise band or a key is pressed. This is used to wake the keypad up from being idle.
+    bool motionDetected = false;
+
+    const TBoard *board = nullptr;
+    std::array<HEKey, TBoard::heKeyCount> heKeys;
+    std::array<DigitalKey, TBoard::digitalKeyCount> digitalKeys;
 
 private:
     void updateSensorBoundaries(HEKey &key);
+    void trackSensorDrift(HEKey &key);
+    void sampleHEKey(HEKey &key);
     void checkHEKey(HEKey &key);
+    void checkActuationPoints(HEKey &key);
+    void performAction(HEKey &key, uint8_t point, ActuationAction action);
     void checkDigitalKey(DigitalKey &key);
     void scanHEKey(HEKey &key);
+    uint16_t compensateCrosstalk(const HEKey &key, uint16_t value);
+    void updateCrosstalkCalibration();
     void scanDigitalKey(DigitalKey &key);
     void setPressedState(Key &key, bool pressed);
+    void recordTransition(Key &key, bool pressed);
+    static bool isSameActuationPoint(const ActuationPoint &a, const ActuationPoint &b);
+    uint16_t resolveSOCD();
+    void updateReport(uint16_t suppressed);
+    void updateKeyMode(Key &key, uint8_t id, bool pressed, bool holdReached);
+    void performTap(Key &key);
+    void performHold(Key &key, uint8_t id);
+    void updateOutput(Key &key, bool pressed);
+    char getKeyChar(const Key &key);
+    void setOutput(const Key &key, KeyOutput &output, bool pressed);
+    void tapOutput(const Key &key, KeyOutput &output);
+    void queueEdge(const Key &key, KeyOutput &output);
+    bool sendEdge(KeyOutput &output);
+    uint16_t getBlockedSOCDPresses();
+    void sendReport();
+#ifdef USE_GAUSS_CORRECTION_LUT
+    void assignGaussLUTs();
+    void updateGaussCalibration();
+#endif
+
+    // Bool whether the HID report changed outside of the queued edges and has to be sent on the next opportunity.
+    bool reportChanged = false;
+
+    // The sequence number of the last key press, incremented with every press.
+    uint32_t pressSequence = 0;
+
+    // The index of the next Hall Effect key to receive an extra sample if it is active.
+    uint8_t nextPriorityKey = 0;
+
+    // The scheduler for the hold times of the tap-hold keys. Every key has its own id, the Hall Effect keys followed by the digital keys,
+    // and only one pending hold, so the capacity of one event per key guarantees that scheduling a hold never fails.
+    EventScheduler<TBoard::heKeyCount + TBoard::digitalKeyCount> scheduler;
+
+    // The layers that are currently held by momentary layer keys and held tap-hold keys, and the ones toggled on, as bitmasks.
+    uint8_t momentaryLayers = 0;
+    uint8_t toggledLayers = 0;
+
+    // The tap-hold keys that have been tapped in the current update of the report, as a bitmask of their scheduler ids.
+    static_assert(TBoard::heKeyCount + TBoard::digitalKeyCount <= 32, "The tapped keys only support up to 32 keys.");
+    uint32_t tappedKeys = 0;
 
 #ifdef USE_GAUSS_CORRECTION_LUT
-    GaussLUT gaussLUT = GaussLUT(GAUSS_CORRECTION_PARAM_A, GAUSS_CORRECTION_PARAM_B, GAUSS_CORRECTION_PARAM_C, GAUSS_CORRECTION_PARAM_D);
+    // The pool of gauss correction lookup tables of the Hall Effect keys. Keys with the same gauss correction parameters share a table,
+    // so the pool is sized by the amount of distinct curves rather than the amount of keys. (see GAUSS_LUT_SLOTS)
+    std::array<GaussLUT, (TBoard::heKeyCount < GAUSS_LUT_SLOTS ? TBoard::heKeyCount : GAUSS_LUT_SLOTS)> gaussLUTs;
 #endif
-} KeyHandler;
+};
+
+inline BasicKeyHandler<Board> KeyHandler;
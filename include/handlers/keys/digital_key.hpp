@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include "config/keys/digital_key_config.hpp"
+#include "boards/board_descriptor.hpp"
 #include "handlers/keys/key.hpp"
 #include "helpers/sma_filter.hpp"
 #include "definitions.hpp"
@@ -10,14 +11,17 @@
 struct DigitalKey : Key
 {
     // Default constructor for the DigitalKey struct for initializing the arrays in the KeyHandler class.
-    DigitalKey() : Key(0, nullptr) {}
+    DigitalKey() : Key(0, nullptr, nullptr) {}
 
     // Require every DigitalKey object to pass a KeyConfig object to the underlaying Key object.
-    DigitalKey(uint8_t index, DigitalKeyConfig *config) : Key(index, config), config(config) {}
+    DigitalKey(uint8_t index, DigitalKeyConfig *config, KeyStatistics *statistics) : Key(index, config, statistics), config(config) {}
 
     // The HEKeyConfig object of this digital key.
     DigitalKeyConfig *config;
 
+    // The descriptor of the hardware of this digital key, assigned once the board has been selected.
+    const DigitalKeyDescriptor *descriptor = nullptr;
+
     // The last time a key press on the digital key was sent, in milliseconds since firmware bootup.
     unsigned long lastDebounce = 0;
 
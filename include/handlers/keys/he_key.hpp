@@ -2,22 +2,33 @@
 
 #include <Arduino.h>
 #include "config/keys/he_key_config.hpp"
+#include "boards/board_descriptor.hpp"
 #include "handlers/keys/key.hpp"
 #include "helpers/sma_filter.hpp"
+#include "helpers/noise_stats.hpp"
+#include "helpers/envelope_tracker.hpp"
+#include "helpers/gauss_lut.hpp"
 #include "definitions.hpp"
 
 // A struct representing a Hall Effect key, including it's current runtime state and HEKeyConfig object.
 struct HEKey : Key
 {
     // Default constructor for the HEKey struct for initializing the arrays in the KeyHandler class.
-    HEKey() : Key(0, nullptr) {}
+    HEKey() : Key(0, nullptr, nullptr) {}
 
     // Require every HEKey object to pass a KeyConfig object to the underlaying Key object.
-    HEKey(uint8_t index, HEKeyConfig *config) : Key(index, config), config(config) {}
+    HEKey(uint8_t index, HEKeyConfig *config, KeyStatistics *statistics) : Key(index, config, statistics), config(config) {}
 
     // The HEKeyConfig object of this Hall Effect key.
     HEKeyConfig *config;
 
+    // The descriptor of the hardware of this Hall Effect key, assigned once the board has been selected.
+    const HEKeyDescriptor *descriptor = nullptr;
+
+    // The gauss correction lookup table of this Hall Effect key, assigned once the board has been selected. Null if all
+    // tables of the pool are in use by other curves, in which case the linear mapping is used.
+    GaussLUT *gaussLUT = nullptr;
+
     // State whether the hall effect key is currently inside the rapid trigger zone (below the lower hysteresis).
     bool inRapidTriggerZone = false;
 
@@ -30,15 +41,48 @@ struct HEKey : Key
     // The distance of the magnet from the sensor, calculated through the raw value.
     uint16_t distance = 0;
 
+    // Bool whether the last unfiltered reading left the noise band around the filtered value, meaning the key is moving.
+    bool moving = false;
+
+    // Bool whether the key is active, meaning it gets prioritized when distributing the samples. (see KeyHandler::handle)
+    bool active = false;
+
+    // The amount of passes in which the key has not been sampled because other keys were prioritized.
+    uint8_t skippedScans = 0;
+
     // The highest and lowest values ever read on the sensor. Used for calibration purposes,
     // specifically mapping future values read from the sensors from this range to 0.01mm steps.
-    // By default, set the range from (1<<analog_resolution)-1 to 0 so it can be updated.
+    // By default, set the range from (1<<sensor_resolution)-1 to 0 so it can be updated.
     uint16_t restPosition = 0;
-    uint16_t downPosition = (1 << ANALOG_RESOLUTION) - 1;
+    uint16_t downPosition = (1 << SENSOR_RESOLUTION) - 1;
 
-    // A bool whether the key is "calibrated", meaning the down position boundary has been updated from it's 4095 default value.
+    // A bool whether the key is "calibrated", meaning the down position boundary has been updated from it's default value, the maximum sensor value.
     bool calibrated = false;
 
+    // The envelopes of the readings at rest and when fully pressed, used to track drift of the rest and down position once calibrated.
+    EnvelopeTracker restTracker = EnvelopeTracker(true);
+    EnvelopeTracker downTracker = EnvelopeTracker(false);
+
+    // The amount of times the rest or down position has been recalibrated by the drift tracking.
+    uint32_t recalibrations = 0;
+
+    // Copies of the enabled actuation points of the key, sorted from the highest to the lowest distance, with the distances at which they
+    // are crossed upwards precomputed from the configuration. (see KeyHandler::updateActuationPoints) Copies are used so that the keys held
+    // by the actuation points can still be released properly after the configuration has been changed.
+    uint8_t actuationPointCount = 0;
+    ActuationPoint actuationPoints[ACTUATION_POINTS];
+    uint16_t actuationReleaseDistances[ACTUATION_POINTS];
+
+    // The amount of actuation points the key is currently below.
+    uint8_t actuationLevel = 0;
+
+    // The outputs of the key chars of the actuation points in the HID report.
+    KeyOutput actuationOutputs[ACTUATION_POINTS];
+
     // The simple moving average filter for stabilizing the analog outpt.
     SMAFilter filter = SMAFilter(SMA_FILTER_SAMPLE_EXPONENT);
+
+    // The noise statistics of the unfiltered and filtered sensor readings, measured while the key is resting.
+    NoiseStats rawNoise;
+    NoiseStats filteredNoise;
 };
@@ -2,12 +2,27 @@
 
 #include <Arduino.h>
 #include "config/keys/key_config.hpp"
+#include "config/statistics.hpp"
+#include "handlers/keys/key_output.hpp"
+
+// The states of a key in tap-hold mode.
+enum class TapHoldState : uint8_t
+{
+    // The key is not pressed.
+    Released,
+
+    // The key is pressed, but it is not decided yet whether it is a tap or a hold.
+    Pending,
+
+    // The key has been held past its hold time or hold distance, performing the hold until it is released.
+    Held
+};
 
 // The base struct containing info about the state of a key for the key handler.
 struct Key
 {
-    // Require every Key object to get an index and a KeyConfig object passed from its inheritors.
-    Key(uint8_t index, KeyConfig *config) : index(index), config(config) {}
+    // Require every Key object to get an index, a KeyConfig and a KeyStatistics object passed from its inheritors.
+    Key(uint8_t index, KeyConfig *config, KeyStatistics *statistics) : index(index), config(config), statistics(statistics) {}
 
     // The index of the key. This is used to link this Key object to the corresponding KeyConfig object.
     uint8_t index;
@@ -15,6 +30,30 @@ struct Key
     // The KeyConfig object of this key.
     KeyConfig *config;
 
+    // The KeyStatistics object of this key.
+    KeyStatistics *statistics;
+
     // State whether the key is currently pressed down.
     bool pressed = false;
+
+    // The output of the key char of the key in the HID report. This may differ from the pressed state, e.g. due to SOCD resolution.
+    KeyOutput output;
+
+    // The output of the hold key char of the key in the HID report, if the key is in tap-hold mode.
+    KeyOutput holdOutput;
+
+    // Bool whether the key was pressed on the last update of its mode, used to detect its presses and releases. (see KeyHandler::updateKeyMode)
+    bool lastPressed = false;
+
+    // The tap-hold state of the key, if the key is in tap-hold mode.
+    TapHoldState tapHoldState = TapHoldState::Released;
+
+    // The sequence number of the last press of the key, used to determine the order in which keys have been pressed.
+    uint32_t pressSequence = 0;
+
+    // The time the key was last pressed, in microseconds since firmware bootup. Used for the press durations in the statistics.
+    uint32_t pressTime = 0;
+
+    // The time the last sample of the key was taken, in microseconds since firmware bootup. Used for the records of the latency beacon.
+    uint32_t sampleTime = 0;
 };
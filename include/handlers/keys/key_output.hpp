@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The output of a key char in the HID report, with a queue of the edges (presses and releases) still to be sent. Since the edges
+// of a key char always alternate between press and release, the queue is represented by the amount of edges in it.
+struct KeyOutput
+{
+    // The key char sent by this output. It is only replaced while nothing is pressed or queued, so releases always match their press.
+    char keyChar = '\0';
+
+    // State whether the key char is currently pressed in the HID report.
+    bool reported = false;
+
+    // The amount of edges queued to be sent, the first one being the opposite of the reported state.
+    uint8_t queuedEdges = 0;
+
+    // The times of the samples that caused the queued edges and the times they were queued, in microseconds since firmware bootup,
+    // for the records of the latency beacon. (see LatencyBeacon) These form a ring buffer, starting with the edge that is sent next.
+    uint8_t queueStart = 0;
+    uint32_t sampleTimes[KEY_OUTPUT_QUEUE_SIZE] = {0};
+    uint32_t queueTimes[KEY_OUTPUT_QUEUE_SIZE] = {0};
+
+    // Returns the state of the key char once all queued edges have been sent.
+    bool getTarget() const { return reported ^ (queuedEdges & 1); }
+};
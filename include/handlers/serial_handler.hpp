@@ -1,6 +1,7 @@
 #pragma once
 
 #include "config/configuration_controller.hpp"
+#include "handlers/keys/key.hpp"
 
 inline class SerialHandler
 {
@@ -13,13 +14,41 @@ private:
     void get();
     void name(char *name);
     void out();
+    void idle(uint32_t timeout);
+    void stats(char *action);
+    void gp(bool state);
+    void gpcurve(uint16_t value);
+    void gpdz(uint16_t value);
+    void chatter(uint16_t threshold);
+    void checkpoint(uint16_t interval);
+    void printKeyStatistics(const char *identifier, const Key &key);
+    void printKeyMode(const char *identifier, const Key &key);
+    uint8_t parseKeyChar(const char *input);
+    void noise();
+    void tune();
+    void socd(char *parameters);
+    void log();
+    void xtalk(char *action);
+    void latency(bool state);
+    void deadline(char *action);
+    void gcal(char *parameters);
     void echo(char *input);
+    void prof(char *action, char *parameters);
     void hkey_rt(HEKeyConfig &config, bool state);
     void hkey_crt(HEKeyConfig &config, bool state);
     void hkey_rtus(HEKeyConfig &config, uint16_t value);
     void hkey_rtds(HEKeyConfig &config, uint16_t value);
     void hkey_lh(HEKeyConfig &config, uint16_t value);
     void hkey_uh(HEKeyConfig &config, uint16_t value);
+    void hkey_drift(HEKeyConfig &config, bool state);
+    void hkey_os(HEKeyConfig &config, uint8_t value);
+    void hkey_ap(HEKeyConfig &config, char *parameters);
+    void hkey_holddist(HEKeyConfig &config, uint16_t value);
     void key_char(KeyConfig &config, uint8_t keyChar);
     void key_hid(KeyConfig &config, bool state);
+    void key_mode(KeyConfig &config, uint8_t mode);
+    void key_layer(KeyConfig &config, uint8_t layer);
+    void key_hold(KeyConfig &config, uint8_t keyChar);
+    void key_holdtime(KeyConfig &config, uint16_t value);
+    void key_lchar(KeyConfig &config, char *parameters);
 } SerialHandler;
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ADCHelper
+{
+    void begin();
+    void beginPin(uint8_t pin);
+    uint16_t readOversampled(uint8_t pin, uint8_t exponent);
+};
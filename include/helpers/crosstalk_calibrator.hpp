@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include "boards/boards.hpp"
+#include "definitions.hpp"
+
+// The states of a crosstalk calibration, from recording the presses of the keys to the measured crosstalk matrix.
+enum class CrosstalkCalibrationState : uint8_t
+{
+    // No calibration has been started yet.
+    Idle = 0,
+
+    // Waiting for every key to be pressed down fully on its own once, recording the shift of the readings of the other keys.
+    Recording = 1,
+
+    // Every key has been pressed and the crosstalk matrix is available.
+    Done = 2,
+
+    // The calibration timed out before every key has been pressed.
+    Failed = 3
+};
+
+class CrosstalkCalibrator
+{
+public:
+    // Starts recording with the specified filtered readings of all Hall Effect keys as their readings at rest.
+    void begin(const uint16_t *values);
+
+    // Passes the filtered, uncompensated readings and the distances of all Hall Effect keys into the recording.
+    void update(const uint16_t *values, const uint16_t *distances);
+
+    // The state of the calibration and the keys that have been pressed down fully on their own, as a bitmask of their indices.
+    CrosstalkCalibrationState state = CrosstalkCalibrationState::Idle;
+    uint16_t completedKeys = 0;
+
+    // The measured crosstalk matrix, valid once the calibration is done. (see Configuration::crosstalk)
+    int16_t coefficients[Board::heKeyCount][Board::heKeyCount] = {};
+
+private:
+    // The readings of the keys at rest at the time the calibration was started.
+    uint16_t baselines[Board::heKeyCount];
+
+    // The sums of the products of the deflection of the pressed key with the shift of every other key, and of its deflection
+    // with itself, for the least squares fit of the shift of every key over the deflection of every other key.
+    int64_t covariances[Board::heKeyCount][Board::heKeyCount];
+    int64_t variances[Board::heKeyCount];
+
+    // The keys that have been pressed down fully since they last rested, as a bitmask of their indices.
+    uint16_t bottomedOutKeys = 0;
+
+    // The time in milliseconds at which the calibration was started.
+    uint32_t startTime = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The stages of an iteration of the main loop, as measured by the deadline monitor.
+enum class LoopStage : uint8_t
+{
+    // Scanning the keys and sending the HID report. (see KeyHandler::handle)
+    Keys = 0,
+
+    // Sending the gamepad report. (see GamepadHandler::handle)
+    Gamepad = 1,
+
+    // Updating the idle mode, including the sleep between two scans while idle. (see IdleHandler::handle)
+    Idle = 2,
+
+    // Checkpointing the statistics to the EEPROM. (see StatisticsController::handle)
+    Statistics = 3,
+
+    // The time outside of the firmware between two iterations, spent in the core (e.g. the USB stack).
+    Core = 4,
+
+    // Handling the serial input. (see serialEvent)
+    SerialInput = 5
+};
+
+// The amount of stages of an iteration of the main loop.
+#define LOOP_STAGES 6
+
+// The context of an iteration of the main loop, as a bitmask of the following flags.
+enum class DeadlineFlag : uint8_t
+{
+    // A serial command has been handled.
+    SerialCommand = 1 << 0,
+
+    // The configuration or the statistics have been written to the EEPROM, which stalls the firmware while the flash is written.
+    EEPROMCommit = 1 << 1,
+
+    // A keyboard report has been handed to the USB stack.
+    ReportSent = 1 << 2,
+
+    // The USB device is mounted by a host.
+    UsbMounted = 1 << 3,
+
+    // The USB bus is suspended by the host.
+    UsbSuspended = 1 << 4
+};
+
+// A snapshot of an iteration of the main loop that exceeded the deadline.
+struct DeadlineSnapshot
+{
+    // The time the iteration started, in milliseconds since firmware bootup.
+    uint32_t timestamp;
+
+    // The time the iteration took, not including the time slept while idle, in microseconds.
+    uint32_t duration;
+
+    // The time spent in every stage of the iteration, in microseconds. (see LoopStage)
+    uint32_t stageTimes[LOOP_STAGES];
+
+    // The time spent handing keyboard reports to the USB stack, in microseconds.
+    uint32_t reportTime;
+
+    // The context of the iteration. (see DeadlineFlag)
+    uint8_t flags;
+
+    // The USB frame number at the end of the iteration.
+    uint16_t frame;
+};
+
+// The deadline monitor measures every iteration of the main loop against the configured deadline. Averages hide single stalled iterations,
+// which are what delays or swallows a tap, so every overrun is counted and the worst ones are kept as snapshots with the time spent in every
+// stage and the context of the iteration, such as handled serial commands, EEPROM writes, sent reports and the state of the USB device.
+inline class DeadlineMonitor
+{
+public:
+    void beginIteration();
+    void mark(LoopStage stage, bool excluded = false);
+    void reset();
+
+    // Adds the specified flag to the context of the current iteration.
+    void flag(DeadlineFlag flag) { flags |= (uint8_t)flag; }
+
+    // The time spent handing keyboard reports to the USB stack in the current iteration, in microseconds.
+    uint32_t reportTime = 0;
+
+    // The amount of measured iterations, the amount of them that exceeded the deadline and the longest one, in microseconds.
+    uint32_t iterations = 0;
+    uint32_t overruns = 0;
+    uint32_t maxDuration = 0;
+
+    // The snapshots of the worst overruns and the amount of them, in the order they were captured.
+    DeadlineSnapshot snapshots[DEADLINE_SNAPSHOTS];
+    uint8_t snapshotCount = 0;
+
+private:
+    void capture(uint32_t duration);
+
+    // The time the current iteration started and the time of the last mark, in microseconds since firmware bootup.
+    uint32_t iterationStart = 0;
+    uint32_t lastMark = 0;
+
+    // The time the current iteration started, in milliseconds since firmware bootup.
+    uint32_t iterationTimestamp = 0;
+
+    // The time spent in every stage of the current iteration and the time that is not counted towards it, in microseconds.
+    uint32_t stageTimes[LOOP_STAGES] = {};
+    uint32_t excludedTime = 0;
+
+    // The context of the current iteration. (see DeadlineFlag)
+    uint8_t flags = 0;
+
+    // Bool whether an iteration has been started, since the first call has no previous iteration to measure.
+    bool started = false;
+} DeadlineMonitor;
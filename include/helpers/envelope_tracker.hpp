@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+class EnvelopeTracker
+{
+public:
+    // Initialize the EnvelopeTracker instance, tracking either the highest (true) or lowest (false) values of a signal.
+    EnvelopeTracker(bool trackMaximum) : trackMaximum(trackMaximum) {}
+
+    // Resets the envelope to the specified value.
+    void reset(uint16_t value);
+
+    // Passes the specified value into the tracker. Values further away from the envelope than the outlier threshold are
+    // rejected, unless they persist for long enough to be considered an actual change of the signal. Returns false if rejected.
+    bool update(uint16_t value, uint16_t outlierThreshold);
+
+    // Returns the current value of the envelope.
+    uint16_t get() const { return envelope >> 16; }
+
+    // Bool whether the envelope has been initialized with a value.
+    bool initialized = false;
+
+    // The amount of values that have been rejected as outliers.
+    uint32_t rejected = 0;
+
+private:
+    // Bool whether the highest or lowest values are tracked.
+    bool trackMaximum;
+
+    // The envelope in Q16 fixed-point, so the decay also works on differences of less than one ADC count.
+    uint32_t envelope = 0;
+
+    // The amount of consecutive values that have been rejected as outliers.
+    uint16_t consecutiveOutliers = 0;
+
+    // The last time the envelope decayed, in milliseconds since firmware bootup.
+    unsigned long lastDecay = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+// An event of the event scheduler, identified by an id chosen by the caller (e.g. the index of a key) and due at the specified time.
+struct ScheduledEvent
+{
+    // The time in milliseconds since firmware bootup at which the event is due.
+    uint32_t time;
+
+    // The id of the event.
+    uint8_t id;
+};
+
+// A scheduler for timed events with a fixed capacity, so that no memory is allocated at runtime. The events are kept sorted by their due time,
+// so checking for due events only looks at the first one, while scheduling and cancelling are bounded by the capacity. Every id can only be
+// scheduled once, so a capacity of the amount of possible ids guarantees that scheduling never fails.
+template <uint8_t Capacity>
+class EventScheduler
+{
+public:
+    // Schedules the event with the specified id at the specified time, replacing a scheduled event with the same id.
+    // Returns false if the scheduler is full.
+    bool schedule(uint8_t id, uint32_t time)
+    {
+        cancel(id);
+        if (count == Capacity)
+            return false;
+
+        // Insert the event behind all events due before or at the same time, keeping the events sorted. The time difference is
+        // compared as a signed value, so the order stays correct when the milliseconds since firmware bootup overflow.
+        uint8_t i = count++;
+        for (; i > 0 && (int32_t)(events[i - 1].time - time) > 0; i--)
+            events[i] = events[i - 1];
+
+        events[i] = {time, id};
+        return true;
+    }
+
+    // Cancels the scheduled event with the specified id, if there is one.
+    void cancel(uint8_t id)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (events[i].id != id)
+                continue;
+
+            for (count--; i < count; i++)
+                events[i] = events[i + 1];
+            return;
+        }
+    }
+
+    // Removes the next event if it is due at the specified time and outputs its id. Returns false if no event is due.
+    bool pop(uint32_t now, uint8_t &id)
+    {
+        if (count == 0 || (int32_t)(now - events[0].time) < 0)
+            return false;
+
+        id = events[0].id;
+        for (uint8_t i = 1; i < count; i++)
+            events[i - 1] = events[i];
+        count--;
+        return true;
+    }
+
+private:
+    // The scheduled events, sorted by their due time, and the amount of them.
+    ScheduledEvent events[Capacity];
+    uint8_t count = 0;
+};
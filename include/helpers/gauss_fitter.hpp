@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include "boards/board_descriptor.hpp"
+#include "definitions.hpp"
+
+// The states of a gauss calibration, from recording the sweep of a key to fitting the gauss correction curve to it.
+enum class GaussCalibrationState : uint8_t
+{
+    // No calibration has been started yet.
+    Idle = 0,
+
+    // Waiting for the key to be pressed down slowly, recording the times at which the readings cross the calibration levels.
+    Recording = 1,
+
+    // The sweep has been recorded and the curve is being fitted to it, one curvature candidate per step.
+    Fitting = 2,
+
+    // The curve has been fitted successfully and the parameters are available.
+    Done = 3,
+
+    // The sweep timed out, was too fast or the curve could not be fitted to it.
+    Failed = 4
+};
+
+class GaussFitter
+{
+public:
+    // Starts recording a sweep of the key with the specified index between the specified rest and down position.
+    void begin(uint8_t keyIndex, uint16_t restPosition, uint16_t downPosition);
+
+    // Passes the specified filtered reading of the key into the recording of the sweep.
+    void update(uint16_t value);
+
+    // Evaluates the next curvature candidate of the fitting. Once all candidates have been evaluated, the parameters are calculated.
+    void step();
+
+    // The state of the calibration, the index of the calibrated key and the progress in the current state,
+    // being the amount of levels crossed while recording and the amount of curvature candidates evaluated while fitting.
+    GaussCalibrationState state = GaussCalibrationState::Idle;
+    uint8_t keyIndex = 0;
+    uint8_t progress = 0;
+
+    // The parameters of the fitted curve, valid once the calibration is done.
+    GaussParameters parameters = {};
+
+private:
+    // Returns the ADC value of the calibration level with the specified index, evenly spaced from the rest to the down position.
+    uint16_t getLevel(uint8_t index);
+
+    // Sums up the values required for the least squares fit of the curve with the specified curvature (Q16 fixed-point).
+    void sum(uint32_t curvature, int64_t &covariance, int64_t &variance, int64_t &sumY, int64_t &sumZ);
+
+    // Calculates e^x for the specified x in Q16 fixed-point, returning the result in Q16 fixed-point.
+    static uint32_t exp(uint32_t x);
+
+    // The rest and down position of the key at the time the calibration was started.
+    uint16_t restPosition = 0;
+    uint16_t downPosition = 0;
+
+    // The time in milliseconds at which the calibration was started.
+    uint32_t startTime = 0;
+
+    // The times in microseconds at which the readings crossed the calibration levels. Once the sweep is complete,
+    // these are replaced by the positions of the levels in the sweep, from 0 to 1 in Q16 fixed-point.
+    uint32_t positions[GAUSS_CALIBRATION_LEVELS];
+
+    // The best score and curvature (Q16 fixed-point) found so far while fitting.
+    int64_t bestScore = 0;
+    uint32_t bestCurvature = 0;
+};
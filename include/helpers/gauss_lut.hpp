@@ -1,21 +1,38 @@
 #pragma once
 
 #include <cstdint>
+#include "boards/board_descriptor.hpp"
 #include "definitions.hpp"
 
 class GaussLUT
 {
 public:
-    // Variables for the equation to calculate the ADC reading into a physical distance.
+    // Calculates the lookup table for the specified parameters of the equation to calculate the ADC reading into a physical distance.
     // a = y-stretch, b = x-stretch, c = x-offset, d = y-offset, for more info: https://www.desmos.com/calculator/ps4wd127tu
-    GaussLUT(double a, double b, double c, double d);
+    void build(const GaussParameters &parameters);
+
+    // Starts rebuilding the lookup table for the specified parameters if they differ from the current ones.
+    // The table is not ready until it has been rebuilt in chunks via buildStep().
+    void setParameters(const GaussParameters &parameters);
+
+    // Calculates the next GAUSS_LUT_BUILD_CHUNK_SIZE entries of the lookup table.
+    void buildStep();
 
     uint16_t adcToDistance(const uint16_t adc, uint16_t const restPosition);
 
+    // Bool whether the lookup table has been fully calculated for the current parameters and can be used.
+    bool ready = false;
+
+    // The parameters the lookup table is calculated for.
+    GaussParameters parameters = {};
+
 private:
     // The calculated lookup table used by this GaussLUT instance.
-    uint16_t lut[1 << ANALOG_RESOLUTION];
+    uint16_t lut[1 << ANALOG_RESOLUTION] = {0};
+
+    // The rest position of the keys according to the lookup table, in the sensor resolution.
+    uint16_t lutRestPosition = 0;
 
-    // The rest position of the keys according to the lookup table.
-    uint16_t lutRestPosition;
+    // The index of the next entry of the lookup table to calculate.
+    uint16_t buildIndex = 0;
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// A record of the latency beacon, describing the stages of a single edge (press or release) of a key char in the HID report.
+struct LatencyRecord
+{
+    // The key char of the edge and whether it is a press or a release.
+    char keyChar;
+    bool pressed;
+
+    // The time of the sample of the key that caused the edge and the time the edge was queued for the HID report, in microseconds since firmware bootup.
+    uint32_t sampleTime;
+    uint32_t queueTime;
+};
+
+// The latency beacon sends a record for every edge in the HID report via the serial interface, containing the timestamps of the stages of the
+// edge on the device and the USB frame number at the time the report has been handed to the USB stack. Joined with the timestamps of the input
+// events on the host via latency-util.py, this splits the latency into the time spent on the scans and the filter, queued for the report and
+// on the way through the USB host. The beacon is opt-in via the 'latency' command since the records take up time on the serial interface.
+inline class LatencyBeacon
+{
+public:
+    void add(char keyChar, bool pressed, uint32_t sampleTime, uint32_t queueTime);
+    void flush();
+
+    // Bool whether the records are sent.
+    bool enabled = false;
+
+    // The amount of records dropped because more edges than LATENCY_BEACON_CAPACITY were in a single report
+    // or the buffer of the serial interface was full.
+    uint32_t dropped = 0;
+
+private:
+    // The records of the edges in the report that is currently being sent.
+    LatencyRecord records[LATENCY_BEACON_CAPACITY];
+    uint8_t count = 0;
+} LatencyBeacon;
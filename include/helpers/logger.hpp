@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "definitions.hpp"
+
+// Define the macros for logging on the different levels. The level is prepended to the format string at compile time, so it costs nothing at
+// runtime, and calls above the compiled LOG_LEVEL are removed entirely. Format strings support the integer, character and floating point
+// conversions of printf, but no strings, since only the raw arguments are stored and formatted later on the host via log-util.py.
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) Logger.write("E " fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) Logger.write("W " fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) Logger.write("I " fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) Logger.write("D " fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) ((void)0)
+#endif
+
+// A logger with deferred formatting. Instead of formatting the text on the device, every call stores the address of its format string, which
+// resides in the flash and therefore identifies it, a timestamp and the raw arguments as 32-bit words in a ring buffer. The ring buffer is drained
+// as binary via the 'log' command and the text is rebuilt on the host from the format strings in the firmware ELF, making a log call cheap enough
+// for the scan path. The ring buffer is lock-free for a single producer and a single consumer, which are the log calls and the 'log' command.
+// Log calls must therefore not be made from interrupt handlers.
+inline class Logger
+{
+public:
+    template <typename... TArgs>
+    void write(const char *format, TArgs... args)
+    {
+        static_assert(sizeof...(TArgs) <= LOG_MAX_ARGUMENTS, "Too many arguments for a single log call.");
+        static_assert((std::is_arithmetic_v<TArgs> && ...), "Only integers, characters and floating point numbers can be logged.");
+
+        // Convert the arguments to 32-bit words and push them as a record. Floating point numbers are stored as single precision.
+        // The array has one spare word so it is not zero-sized for log calls without arguments.
+        uint32_t words[sizeof...(TArgs) + 1] = {toWord(args)...};
+        push(format, words, sizeof...(TArgs));
+    }
+
+    const uint32_t *peek(uint32_t &count);
+    void consume(uint32_t count);
+
+    // The amount of records dropped because the ring buffer was full. This is only written by the producer and never reset.
+    std::atomic<uint32_t> dropped{0};
+
+private:
+    void push(const char *format, const uint32_t *arguments, uint32_t count);
+
+    template <typename T>
+    static uint32_t toWord(T value)
+    {
+        // Reinterpret floating point numbers as their bits, since a conversion would lose the fraction.
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            float single = value;
+            uint32_t word;
+            memcpy(&word, &single, sizeof(word));
+            return word;
+        }
+        // Integers are sign-extended, so the host can restore negative values of any width from the 32-bit word.
+        else
+            return static_cast<uint32_t>(static_cast<int32_t>(value));
+    }
+
+    // The ring buffer of 32-bit words and the positions of the producer and the consumer. The positions are not wrapped, but only masked on access.
+    // Since the producer only writes the head and the consumer only writes the tail, no locks are needed.
+    uint32_t buffer[LOG_BUFFER_SIZE] = {};
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+} Logger;
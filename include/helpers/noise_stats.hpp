@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+class NoiseStats
+{
+public:
+    // Passes the specified value into the current window. Once the window is full, the results are published.
+    void add(uint16_t value);
+
+    // Discards the current window, e.g. because the key left its rest position.
+    void discard();
+
+    // Calculates the integer square root of the specified value, rounded down.
+    static uint32_t sqrt(uint64_t value);
+
+    // Bool whether at least one window has been completed and the results below are valid.
+    bool valid = false;
+
+    // The mean, standard deviation (Q8 fixed-point) and peak-to-peak range of the last completed window.
+    uint16_t mean = 0;
+    uint32_t standardDeviation = 0;
+    uint16_t peakToPeak = 0;
+
+private:
+    // The amount of values in the current window.
+    uint16_t count = 0;
+
+    // The running mean (Q8 fixed-point) and sum of squared differences (Q16 fixed-point) for Welford's algorithm.
+    int32_t runningMean = 0;
+    int64_t m2 = 0;
+
+    // The lowest and highest value in the current window.
+    uint16_t lowest = UINT16_MAX;
+    uint16_t highest = 0;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+#if DEV
+
+// A bucket of the histogram of the profiler, counting the samples of the program counter within PROFILER_BUCKET_SIZE bytes of code.
+struct ProfilerBucket
+{
+    // The address of the first instruction covered by the bucket, or 0 if the bucket is unused.
+    uint32_t address;
+
+    // The amount of samples that hit the code covered by the bucket.
+    uint32_t count;
+};
+
+// A statistical profiler, sampling the program counter interrupted by a periodic timer interrupt into a histogram of code addresses.
+// The histogram is symbolized on the host against the firmware ELF via profiler-util.py. Only available in development environments.
+inline class Profiler
+{
+public:
+    void start(uint32_t interval);
+    void stop();
+    void reset();
+    void sample(uint32_t pc);
+
+    // Bool whether the profiler is currently sampling.
+    bool running = false;
+
+    // The interval between two samples in microseconds.
+    uint32_t interval = 0;
+
+    // The amount of samples taken and the amount of samples dropped because the histogram was full.
+    uint32_t samples = 0;
+    uint32_t dropped = 0;
+
+    // The histogram of the sampled program counters, as an open-addressed hash table keyed by the address of the bucket.
+    ProfilerBucket buckets[1 << PROFILER_BUCKETS_EXPONENT] = {};
+
+private:
+    // The hardware alarm used for the timer interrupt, claimed on the first start.
+    int alarm = -1;
+} Profiler;
+
+#endif
@@ -1,21 +1,27 @@
 #pragma once
 
 #include <cstdint>
+#include "definitions.hpp"
 
 class SMAFilter
 {
 public:
     // Initialize the SMAFilter instance with the specified sample exponent.
-    // (1 = 1 sample, 2 = 4 samples, 3 = 8 samples, ...)
+    // (0 = 1 sample, 1 = 2 samples, 2 = 4 samples, 3 = 8 samples, ...)
     SMAFilter(uint8_t samplesExponent)
         : samplesExponent(samplesExponent)
         , samples(1 << samplesExponent)
-        , buffer(new uint16_t[samples] {0})
     {}
 
     // The call operator for passing values through the filter.
     uint16_t operator()(uint16_t value);
 
+    // Fills the whole buffer with the specified value, so that the filter starts out at it instead of ramping up from 0.
+    void fill(uint16_t value);
+
+    // Returns the sample exponent this filter was initialized with.
+    uint8_t getSamplesExponent() const { return samplesExponent; }
+
     // Bool whether the whole buffer has been written at least once.
     bool initialized = false;
 
@@ -24,8 +30,9 @@ private:
     uint8_t samplesExponent;
     uint8_t samples;
 
-    // The buffer containing all values.
-    uint16_t *buffer;
+    // The buffer containing all values. It is sized for the maximum amount of samples so the sample
+    // exponent can be changed at runtime (e.g. through auto-tuning) without any heap allocations.
+    uint16_t buffer[1 << SMA_FILTER_MAX_SAMPLE_EXPONENT] = {0};
 
     // The index of the oldest and thus next element to overwrite.
     uint8_t index = 0;
@@ -0,0 +1,120 @@
+import sys
+import time
+import argparse
+import threading
+
+# A record of the latency beacon, describing the stages of a single press or release on the device
+class LatencyRecord:
+    def __init__(self, line: str):
+        parts = line.split(" ")
+        self.key = chr(int(parts[1])).lower()
+        self.pressed = parts[2] == "1"
+        self.sample_time, self.queue_time, self.send_time = (int(x) for x in parts[3:6])
+        self.handoff_frame = int(parts[6])
+        self.dropped = int(parts[7])
+
+# Read the records of the latency beacon from the serial port until the stop event is set
+def read_records(port: str, records: list[LatencyRecord], stop: threading.Event) -> None:
+    # Import pyserial here, so that the help can be shown without it
+    import serial
+
+    with serial.Serial(port, 115200, timeout=0.5) as s:
+        s.write(b"latency 1\n")
+        while not stop.is_set():
+            line = s.readline().decode("ascii", errors="replace").strip()
+            if line.startswith("LAT "):
+                records.append(LatencyRecord(line))
+
+        s.write(b"latency 0\n")
+
+# Get the value at the specified percentile of the sorted list of values
+def percentile(values: list[float], p: float) -> float:
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+# Print the minimum, median, 99th percentile and maximum of the specified stage
+def print_stage(name: str, values: list[float]) -> None:
+    values = sorted(values)
+    print(f"{name:<28} {values[0]:>9.0f} {percentile(values, 50):>9.0f} {percentile(values, 99):>9.0f} {values[-1]:>9.0f}")
+
+# Fit a line through the specified points via least squares, returning the slope and intercept
+def fit_line(points: list[tuple[float, float]]) -> tuple[float, float]:
+    n = len(points)
+    mean_x = sum(x for x, _ in points) / n
+    mean_y = sum(y for _, y in points) / n
+    variance = sum((x - mean_x) ** 2 for x, _ in points)
+    slope = sum((x - mean_x) * (y - mean_y) for x, y in points) / variance if variance > 0 else 0
+    return (slope, mean_y - slope * mean_x)
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Measures the latency of the stages of every press and release of a minipad, by joining the records of its latency beacon with the input events of the operating system.")
+    parser.add_argument("--port", required=True, help="the serial port of the minipad")
+    parser.add_argument("--duration", type=float, default=30, help="the duration of the measurement in seconds (default: 30)")
+    parser.add_argument("--csv", help="a file to write the joined records to")
+    args = parser.parse_args()
+
+    # Import pynput here, so that the help can be shown without it
+    from pynput import keyboard
+
+    # Record the input events of the operating system with the time they were received. Repeated presses of a held key are ignored.
+    events: list[tuple[int, str, bool]] = []
+    held: set[str] = set()
+
+    def on_event(key, pressed: bool) -> None:
+        now = time.perf_counter_ns()
+        char = getattr(key, "char", None)
+        if char is None or (pressed and char.lower() in held):
+            return
+
+        (held.add if pressed else held.discard)(char.lower())
+        events.append((now, char.lower(), pressed))
+
+    records: list[LatencyRecord] = []
+    stop = threading.Event()
+    reader = threading.Thread(target=read_records, args=(args.port, records, stop))
+    reader.start()
+
+    print(f"Press the keys of the minipad for {args.duration:.0f} seconds...")
+    with keyboard.Listener(on_press=lambda key: on_event(key, True), on_release=lambda key: on_event(key, False)):
+        try:
+            time.sleep(args.duration)
+        except KeyboardInterrupt:
+            pass
+
+    stop.set()
+    reader.join()
+
+    # Join the records with the input events in order, separately for every key and direction, since the serial records and the input
+    # events arrive over different paths. Unmatched records and events at the end (e.g. from other keyboards) are dropped.
+    pairs: list[tuple[LatencyRecord, int]] = []
+    for key, pressed in {(record.key, record.pressed) for record in records}:
+        matching_records = [record for record in records if record.key == key and record.pressed == pressed]
+        matching_events = [event[0] for event in events if event[1] == key and event[2] == pressed]
+        pairs.extend(zip(matching_records, matching_events))
+
+    if len(pairs) < 2:
+        print("Not enough presses and releases could be matched, make sure the minipad sends printable characters")
+        sys.exit(1)
+
+    # The clocks of the device and the host are not synchronized and drift apart slowly. The drift is removed via a line fitted through the
+    # differences between the send times and the input events, and the offset is chosen so that the fastest edge took no time from being sent
+    # to arriving at the operating system. The remaining time of this stage is therefore relative to the best case of the USB host.
+    points = [(record.send_time, event / 1000 - record.send_time) for record, event in pairs]
+    slope, intercept = fit_line(points)
+    arrivals = [y - (slope * x + intercept) for x, y in points]
+    offset = min(arrivals)
+
+    print(f"\n{len(pairs)} of {len(records)} records matched, {records[-1].dropped if records else 0} dropped on the device\n")
+    print(f"{'stage (us)':<28} {'min':>9} {'median':>9} {'p99':>9} {'max':>9}")
+    print_stage("sample -> queued", [record.queue_time - record.sample_time for record, _ in pairs])
+    print_stage("queued -> sent", [record.send_time - record.queue_time for record, _ in pairs])
+    print_stage("sent -> os (over best case)", [arrival - offset for arrival in arrivals])
+
+    # Write the joined records, if requested
+    if args.csv:
+        with open(args.csv, "w", encoding="utf8") as f:
+            f.write("key,pressed,sample,queued,sent,handoff_frame,os\n")
+            for (record, event), arrival in zip(pairs, arrivals):
+                f.write(f"{record.key},{int(record.pressed)},{record.sample_time},{record.queue_time},{record.send_time},{record.handoff_frame},{record.send_time + arrival - offset:.0f}\n")
+
+if __name__ == "__main__":
+    main()
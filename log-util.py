@@ -0,0 +1,145 @@
+import re
+import sys
+import time
+import struct
+import argparse
+
+from typing import Optional
+
+# The regex matching a printf conversion, with the flags, width and precision as group 1, the length modifier as group 2 and the conversion as group 3
+CONVERSION_REGEX = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcfFeEgG%])")
+
+# A minimal reader for the sections of a little-endian 32-bit ELF file, used to look up the format strings by their address
+class ELFReader:
+    def __init__(self, path: str):
+        with open(path, "rb") as f:
+            self.data = f.read()
+
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            print(f"'{path}' is not a little-endian 32-bit ELF file")
+            sys.exit(1)
+
+        # Read the section headers, remembering the address, offset and size of all sections that occupy memory and have data in the file
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, type, flags, address, offset, size = struct.unpack_from("<IIIIII", self.data, shoff + i * shentsize)
+            if flags & 0x2 and type != 8:
+                self.sections.append((address, offset, size))
+
+    # Read the zero-terminated string at the specified address, or return None if it does not point into the ELF file
+    def read_string(self, address: int) -> Optional[str]:
+        for start, offset, size in self.sections:
+            if start <= address < start + size:
+                position = offset + address - start
+                end = self.data.find(b"\0", position, offset + size)
+                return self.data[position:end].decode("utf8", errors="replace") if end >= 0 else None
+
+        return None
+
+# Format a record from its format string and the raw 32-bit words of its arguments, as printf on the device would have
+def format_record(fmt: str, words: list[int]) -> str:
+    arguments = iter(words)
+
+    def convert(match: re.Match) -> str:
+        spec, conversion = match.group(1), match.group(3)
+        if conversion == "%":
+            return "%"
+
+        word = next(arguments, 0)
+        if conversion in "di":
+            value = word - (1 << 32) if word & 0x80000000 else word
+        elif conversion in "fFeEgG":
+            value, = struct.unpack("<f", struct.pack("<I", word))
+        elif conversion == "u":
+            value, conversion = word, "d"
+        else:
+            value = word
+
+        return f"%{spec}{conversion}" % value
+
+    return CONVERSION_REGEX.sub(convert, fmt)
+
+# Get the amount of arguments a format string consumes
+def count_arguments(fmt: str) -> int:
+    return sum(1 for match in CONVERSION_REGEX.finditer(fmt) if match.group(3) != "%")
+
+# Decode the binary records of the logger into lines of text. Every record consists of the address of its format string, the timestamp in
+# microseconds and its arguments as little-endian 32-bit words. The amount of arguments is derived from the format string.
+def decode(elf: ELFReader, data: bytes) -> list[str]:
+    words = [word for word, in struct.iter_unpack("<I", data[:len(data) // 4 * 4])]
+    lines = []
+    i = 0
+    while i + 2 <= len(words):
+        fmt = elf.read_string(words[i])
+        if fmt is None:
+            lines.append(f"<unknown format string 0x{words[i]:08x}, the ELF does not match the firmware>")
+            break
+
+        count = count_arguments(fmt)
+        timestamp = words[i + 1]
+        level, text = fmt[0], fmt[2:]
+        lines.append(f"[{timestamp / 1000000:>12.6f}] {level} {format_record(text, words[i + 2:i + 2 + count])}")
+        i += 2 + count
+
+    return lines
+
+# Read the log from the serial port of the minipad, returning the amount of dropped records and the binary records
+def read_log_from_serial(s) -> tuple[int, bytes]:
+    s.write(b"log\n")
+
+    dropped = 0
+    data = b""
+    while True:
+        line = s.readline().decode("ascii", errors="replace").strip()
+        if not line:
+            print("Timed out while reading the log from the serial port")
+            sys.exit(1)
+        elif line == "LOG END":
+            return (dropped, data)
+        elif line.startswith("LOG dropped="):
+            dropped = int(line[12:])
+        elif line.startswith("LOG size="):
+            # Read the binary block and the newline character following it
+            data += s.read(int(line[9:]))
+            s.readline()
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Decodes the binary log of a minipad using the format strings in the firmware ELF.")
+    parser.add_argument("elf", help="the firmware ELF the minipad is running (e.g. .pio/build/minipad-3k-dev/firmware.elf)")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="the serial port of the minipad to read the log from")
+    source.add_argument("--input", help="a file containing the binary records of the log")
+    parser.add_argument("--follow", action="store_true", help="keep reading the log from the serial port until interrupted")
+    parser.add_argument("--interval", type=float, default=0.2, help="the interval in seconds between two reads when following (default: 0.2)")
+    args = parser.parse_args()
+
+    elf = ELFReader(args.elf)
+
+    # Decode the binary records of a file
+    if args.input:
+        with open(args.input, "rb") as f:
+            print("\n".join(decode(elf, f.read())))
+        return
+
+    # Import pyserial here, so that decoding a saved log does not require it
+    import serial
+
+    with serial.Serial(args.port, 115200, timeout=5) as s:
+        last_dropped = 0
+        while True:
+            dropped, data = read_log_from_serial(s)
+            if dropped != last_dropped:
+                print(f"<{dropped - last_dropped} records dropped>")
+            last_dropped = dropped
+
+            for line in decode(elf, data):
+                print(line)
+
+            if not args.follow:
+                break
+            time.sleep(args.interval)
+
+if __name__ == "__main__":
+    main()
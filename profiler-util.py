@@ -0,0 +1,107 @@
+import sys
+import bisect
+import argparse
+import subprocess
+
+from typing import Optional
+
+# Read the histogram of the profiler from the serial port of a minipad running a development build
+def read_histogram_from_serial(port: str) -> list[str]:
+    # Import pyserial here, so that symbolizing a saved dump does not require it
+    import serial
+
+    with serial.Serial(port, 115200, timeout=5) as s:
+        s.write(b"prof\n")
+
+        # Read the lines until the end of the histogram was signalized
+        lines = []
+        while True:
+            line = s.readline().decode("ascii", errors="replace").strip()
+            if not line:
+                print("Timed out while reading the histogram from the serial port")
+                sys.exit(1)
+            if line == "PROF END":
+                return lines
+            lines.append(line)
+
+# Parse the output of the 'prof' command into the header values and the (address, count) pairs of the buckets
+def parse_histogram(lines: list[str]) -> tuple[dict[str, int], list[tuple[int, int]]]:
+    header = {}
+    buckets = []
+    for line in lines:
+        if not line.startswith("PROF "):
+            continue
+
+        key, value = line[5:].split("=", 1)
+        if key.startswith("0x"):
+            buckets.append((int(key, 16), int(value)))
+        else:
+            header[key] = int(value)
+
+    return (header, buckets)
+
+# Get all function symbols of the ELF file, sorted by their address, via nm of the ARM toolchain
+def get_symbols(elf: str, nm: str) -> list[tuple[int, int, str]]:
+    output = subprocess.run([nm, "-C", "-S", "--defined-only", elf], capture_output=True, text=True, check=True).stdout
+
+    symbols = []
+    for line in output.splitlines():
+        # Lines with a size look like: <address> <size> <type> <name>
+        parts = line.split(" ", 3)
+        if len(parts) != 4 or parts[2].lower() not in ("t", "w"):
+            continue
+
+        # Clear the thumb bit of the address, since the program counter never has it set
+        symbols.append((int(parts[0], 16) & ~1, int(parts[1], 16), parts[3]))
+
+    return sorted(symbols)
+
+# Look up the function containing the specified address
+def lookup(symbols: list[tuple[int, int, str]], addresses: list[int], address: int) -> Optional[str]:
+    index = bisect.bisect_right(addresses, address) - 1
+    if index < 0:
+        return None
+
+    start, size, name = symbols[index]
+    return name if address < start + max(size, 1) else None
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Symbolizes the histogram of the sampling profiler of a minipad development build.")
+    parser.add_argument("elf", help="the firmware ELF the minipad is running (e.g. .pio/build/minipad-3k-dev/firmware.elf)")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="the serial port of the minipad to read the histogram from")
+    source.add_argument("--input", help="a file containing the output of the 'prof' command")
+    parser.add_argument("--top", type=int, default=30, help="the amount of functions to show (default: 30)")
+    parser.add_argument("--nm", default="arm-none-eabi-nm", help="the nm executable of the ARM toolchain")
+    args = parser.parse_args()
+
+    # Read and parse the histogram
+    if args.port:
+        lines = read_histogram_from_serial(args.port)
+    else:
+        with open(args.input, encoding="utf8") as f:
+            lines = [line.strip() for line in f.readlines()]
+
+    header, buckets = parse_histogram(lines)
+    total = sum(count for _, count in buckets)
+    if total == 0:
+        print("The histogram is empty, start the profiler with 'prof start' first")
+        sys.exit(1)
+
+    # Attribute the samples of every bucket to the function containing the start of the bucket. Buckets spanning
+    # the end of a function are attributed to it as a whole, which is negligible with the small bucket size.
+    symbols = get_symbols(args.elf, args.nm)
+    addresses = [symbol[0] for symbol in symbols]
+    functions: dict[str, int] = {}
+    for address, count in buckets:
+        name = lookup(symbols, addresses, address) or f"<unknown 0x{address:08x}>"
+        functions[name] = functions.get(name, 0) + count
+
+    # Print the functions with the most samples
+    print(f"{header.get('samples', total)} samples every {header.get('interval', 0)}us, {header.get('dropped', 0)} dropped\n")
+    print(f"{'samples':>8} {'share':>7}  function")
+    for name, count in sorted(functions.items(), key=lambda x: x[1], reverse=True)[:args.top]:
+        print(f"{count:>8} {count / total:>7.2%}  {name}")
+
+if __name__ == "__main__":
+    main()
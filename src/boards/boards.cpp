@@ -0,0 +1,23 @@
+#include <Arduino.h>
+#include <iterator>
+#include "boards/boards.hpp"
+
+const Board &selectBoard()
+{
+    // Read the strap pins as a binary number, starting with the least significant bit. The pins are pulled up,
+    // meaning that an unstrapped pin reads as a 0 bit and the first variant is selected on boards without straps.
+    size_t variant = 0;
+    for (size_t i = 0; i < BOARD_STRAP_PINS.size(); i++)
+    {
+        pinMode(BOARD_STRAP_PINS[i], INPUT_PULLUP);
+        delayMicroseconds(10);
+        if (digitalRead(BOARD_STRAP_PINS[i]) == PinStatus::LOW)
+            variant |= 1 << i;
+    }
+
+    // Fall back to the first variant if the strap pins select a variant that does not exist.
+    if (variant >= std::size(BOARD_VARIANTS))
+        variant = 0;
+
+    return BOARD_VARIANTS[variant];
+}
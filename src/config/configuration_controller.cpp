@@ -1,6 +1,7 @@
 #include <EEPROM.h>
 #include <Arduino.h>
 #include "config/configuration_controller.hpp"
+#include "helpers/deadline_monitor.hpp"
 
 void ConfigurationController::loadConfig()
 {
@@ -20,4 +21,7 @@ void ConfigurationController::saveConfig()
     // Write the struct back into the EEPROM and commit the change.
     EEPROM.put(0, config);
     EEPROM.commit();
+
+    // Writing to the flash stalls the firmware, so mark the current loop iteration for the deadline monitor.
+    DeadlineMonitor.flag(DeadlineFlag::EEPROMCommit);
 }
@@ -0,0 +1,51 @@
+#include <EEPROM.h>
+#include <Arduino.h>
+#include "config/statistics_controller.hpp"
+#include "config/configuration_controller.hpp"
+#include "helpers/deadline_monitor.hpp"
+
+// The statistics are stored right behind the configuration, so both have to fit into the EEPROM together.
+static_assert(sizeof(Configuration) + sizeof(Statistics) <= EEPROM_SIZE, "The configuration and statistics do not fit into the EEPROM.");
+
+void StatisticsController::loadStatistics()
+{
+    // Load the statistics struct from the EEPROM.
+    EEPROM.get(sizeof(Configuration), statistics);
+
+    // Check if the version matches with the one read; If not, start over with empty statistics. This also happens if the
+    // layout of the configuration changed, since the statistics are then read from a different location.
+    if (statistics.version != Statistics::getVersion())
+        statistics = Statistics();
+}
+
+void StatisticsController::saveStatistics()
+{
+    // Write the struct into the EEPROM behind the configuration and commit the change, marking the stall for the deadline monitor.
+    EEPROM.put(sizeof(Configuration), statistics);
+    EEPROM.commit();
+    DeadlineMonitor.flag(DeadlineFlag::EEPROMCommit);
+}
+
+void StatisticsController::resetStatistics()
+{
+    // Replace the statistics with empty ones, the checkpoint in the EEPROM is overwritten on the next checkpoint.
+    statistics = Statistics();
+}
+
+void StatisticsController::handle(bool idle)
+{
+    // Checkpoint the statistics to the EEPROM once the configured interval has passed. A write to the flash stalls the whole
+    // firmware for a while, so this only happens while the keypad is idle, or while it is not in use if the idle mode is disabled.
+    // An interval of 0 disables the checkpoints.
+    uint32_t interval = ConfigController.config.statisticsCheckpointInterval * 60000UL;
+    if (interval == 0 || !idle || millis() - lastCheckpoint < interval)
+        return;
+
+    lastCheckpoint = millis();
+
+    // Only write the statistics if they changed since the last checkpoint, to not wear out the flash while nobody is playing.
+    Statistics checkpoint;
+    EEPROM.get(sizeof(Configuration), checkpoint);
+    if (memcmp(&checkpoint, &statistics, sizeof(Statistics)) != 0)
+        saveStatistics();
+}
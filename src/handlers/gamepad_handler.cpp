@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include <Joystick.h>
+#include <tusb.h>
+#include "handlers/gamepad_handler.hpp"
+#include "handlers/key_handler.hpp"
+#include "definitions.hpp"
+
+void GamepadHandler::begin()
+{
+    // Send the reports manually once all axes have been updated, with the full 16-bit range on every axis.
+    Joystick.begin();
+    Joystick.useManualSend(true);
+    Joystick.use16bit();
+
+    // Precompute the response curve from the loaded configuration.
+    updateResponseCurve();
+}
+
+void GamepadHandler::updateResponseCurve()
+{
+    // Calculate the axis value for every travel distance. Everything inside the deadzone at the top maps to the lowest value, the remaining
+    // travel is normalized to 0-1 and raised to the power of the configured curve (in percent), e.g. 100 for linear or 200 for quadratic.
+    const Configuration &config = ConfigController.config;
+    for (uint16_t travel = 0; travel <= TRAVEL_DISTANCE_IN_0_01MM; travel++)
+    {
+        double value = 0;
+        if (travel > config.gamepadDeadzone)
+            value = pow((double)(travel - config.gamepadDeadzone) / (TRAVEL_DISTANCE_IN_0_01MM - config.gamepadDeadzone), config.gamepadCurve / 100.0);
+
+        responseCurve[travel] = -32767 + (int32_t)(value * 65534);
+    }
+}
+
+void GamepadHandler::handle()
+{
+    // If the gamepad output is disabled, there is nothing to do.
+    if (!ConfigController.config.gamepadOutput)
+        return;
+
+    // Convert the distance of the first Hall Effect keys into axis values, where the key being fully pressed is the highest value.
+    // The axes follow the travel distance, so they move in steps of 0.01mm rather than with the resolution of the sensor readings.
+    int16_t values[GAMEPAD_AXES];
+    bool changed = false;
+    for (uint8_t i = 0; i < GAMEPAD_AXES; i++)
+    {
+        values[i] = i < Board::heKeyCount ? responseCurve[TRAVEL_DISTANCE_IN_0_01MM - KeyHandler.heKeys[i].distance] : axes[i];
+        changed |= values[i] != axes[i];
+    }
+
+    // Only send a report if any axis changed. The report is sent with the next poll of the host, at the full polling rate.
+    if (!changed)
+        return;
+
+    // The gamepad shares the HID endpoint with the keyboard, whose report might just have been handed to the USB stack. If the endpoint
+    // is busy, the report would be dropped silently, so the axes are not updated and the report is sent on a later pass instead.
+    if (!tud_hid_ready())
+        return;
+
+    Joystick.X(values[0]);
+    Joystick.Y(values[1]);
+    Joystick.Z(values[2]);
+    Joystick.Zrotate(values[3]);
+    Joystick.sliderLeft(values[4]);
+    Joystick.sliderRight(values[5]);
+    Joystick.send_now();
+
+    // Remember the sent axis values only now that the report has been queued, so that a dropped report is never mistaken for a sent one.
+    for (uint8_t i = 0; i < GAMEPAD_AXES; i++)
+        axes[i] = values[i];
+}
@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include "handlers/idle_handler.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "pico/time.h"
+}
+
+// Make sure the worst-case latency added by the idle scan interval (the interval plus the time of one scan) stays below one USB frame.
+static_assert(IDLE_SCAN_INTERVAL_US <= 800, "The idle scan interval has to leave room for one scan within a USB frame (1ms).");
+
+void IdleHandler::handle(bool motionDetected)
+{
+    unsigned long now = millis();
+    unsigned long nowMicros = micros();
+
+    // If motion was detected, remember the time and wake up if the keypad is idle.
+    if (motionDetected)
+    {
+        lastMotion = now;
+        if (idle)
+        {
+            // The motion happened somewhere between the last scan and this one, so the time between the two is the worst-case latency.
+            uint32_t latency = nowMicros - lastScan;
+            if (latency > maxWakeLatency)
+                maxWakeLatency = latency;
+
+            idleTime += now - idleSince;
+            wakes++;
+            idle = false;
+        }
+    }
+
+    // If no motion was detected for longer than the configured timeout, the keypad becomes idle. A timeout of 0 disables this.
+    else if (!idle && ConfigController.config.idleTimeout != 0 && now - lastMotion >= ConfigController.config.idleTimeout)
+    {
+        idleSince = now;
+        idle = true;
+    }
+
+    // Remember the time of this scan, before sleeping, for the wake latency measurement on the next one.
+    lastScan = nowMicros;
+
+    // If the keypad is idle, sleep until the next scan. The sleep puts the core into a low-power state until the timer
+    // fires, instead of busy waiting. On the first sample leaving the noise band, the keypad is back at full scan rate.
+    if (idle)
+        sleep_us(IDLE_SCAN_INTERVAL_US);
+}
+
+bool IdleHandler::isQuiet() const
+{
+    // Without the idle mode, fall back to the default idle timeout to tell whether the keypad is in use.
+    return idle || (ConfigController.config.idleTimeout == 0 && millis() - lastMotion >= IDLE_TIMEOUT);
+}
+
+uint32_t IdleHandler::getIdleTime() const
+{
+    // Include the current idle period in the total idle time.
+    return idleTime + (idle ? millis() - idleSince : 0);
+}
@@ -1,8 +1,13 @@
 #include <Arduino.h>
 #include <Keyboard.h>
+#include <tusb.h>
 #include "handlers/key_handler.hpp"
 #include "handlers/serial_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/adc_helper.hpp"
+#include "helpers/logger.hpp"
+#include "helpers/latency_beacon.hpp"
+#include "helpers/deadline_monitor.hpp"
 #include "definitions.hpp"
 
 /*
@@ -51,41 +56,402 @@
    Step 4: Depending on whether the key is pressed or not, remember the lowest/highest peak achieved
 */
 
-void KeyHandler::handle()
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::begin(const TBoard &board)
 {
-    // Go through all Hall Effect keys and run the checks.
+    this->board = &board;
+
+    // Configure the select pins of the multiplexers, if the board has any.
+    for (uint8_t pin : board.muxSelectPins)
+        pinMode(pin, OUTPUT);
+
+    // Set up the ADC once, then assign the descriptors to all Hall Effect keys and set up their pins for the oversampled readings.
+    ADCHelper::begin();
     for (HEKey &key : heKeys)
     {
-        // Scan the Hall Effect key to update the sensor and distance value.
-        scanHEKey(key);
-
-        // Run the checks on the HE key.
-        checkHEKey(key);
+        key.descriptor = &board.heKeys[key.index];
+        ADCHelper::beginPin(key.descriptor->pin);
     }
 
-    // Go through all digital keys and run the checks.
+#ifdef USE_GAUSS_CORRECTION_LUT
+    // Assign the gauss correction lookup tables to all Hall Effect keys and build them at once, since the scans have not started yet.
+    assignGaussLUTs();
+    for (HEKey &key : heKeys)
+        while (key.gaussLUT && !key.gaussLUT->ready)
+            key.gaussLUT->buildStep();
+#endif
+
+    // Precompute the actuation points of all Hall Effect keys from the loaded configuration.
+    for (HEKey &key : heKeys)
+        updateActuationPoints(key);
+
+    // Assign the descriptors to all digital keys.
     for (DigitalKey &key : digitalKeys)
+        key.descriptor = &board.digitalKeys[key.index];
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateActuationPoints(HEKey &key)
+{
+    // Collect the enabled actuation points, sorted from the highest to the lowest distance via insertion sort, so that they are crossed in
+    // order when pressing the key down. The distances at which they are crossed are precomputed here to keep the checks on every sample cheap.
+    // The actuation points are crossed upwards again once the key rises by the rapid trigger tolerance, to not have them flicker on noise.
+    // Actuation points too close to the rest position for their release distance to be reached are skipped, since they would never be
+    // released again. (e.g. after the tolerance has been raised by the auto-tuning)
+    uint8_t count = 0;
+    ActuationPoint points[ACTUATION_POINTS];
+    uint16_t releaseDistances[ACTUATION_POINTS];
+    for (const ActuationPoint &point : key.config->actuationPoints)
+    {
+        if (point.keyChar == '\0' || point.distance + key.config->rapidTriggerTolerance > TRAVEL_DISTANCE_IN_0_01MM)
+            continue;
+
+        uint8_t i = count++;
+        for (; i > 0 && points[i - 1].distance < point.distance; i--)
+        {
+            points[i] = points[i - 1];
+            releaseDistances[i] = releaseDistances[i - 1];
+        }
+
+        points[i] = point;
+        releaseDistances[i] = point.distance + key.config->rapidTriggerTolerance;
+    }
+
+    // If the actuation points did not change (e.g. on a command changing an unrelated setting), there is nothing to do, so that the
+    // outputs and the tap-hold state of the key are not disturbed.
+    bool changed = count != key.actuationPointCount;
+    for (uint8_t i = 0; i < count && !changed; i++)
+        changed = !isSameActuationPoint(points[i], key.actuationPoints[i]) || releaseDistances[i] != key.actuationReleaseDistances[i];
+    if (!changed)
+        return;
+
+    // Carry over the outputs of the actuation points that are still there, along with whether the key is below them. The other outputs
+    // start out released with the key char of their actuation point.
+    KeyOutput outputs[ACTUATION_POINTS];
+    bool crossed[ACTUATION_POINTS] = {false};
+    uint8_t carried = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        outputs[i].keyChar = points[i].keyChar;
+        for (uint8_t j = 0; j < key.actuationPointCount; j++)
+        {
+            if ((carried & (1 << j)) || !isSameActuationPoint(points[i], key.actuationPoints[j]))
+                continue;
+
+            outputs[i] = key.actuationOutputs[j];
+            crossed[i] = j < key.actuationLevel;
+            carried |= 1 << j;
+            break;
+        }
+    }
+
+    // Release the key chars held by the actuation points that have been removed right away and drop their queued edges.
+    for (uint8_t j = 0; j < key.actuationPointCount; j++)
+    {
+        if (carried & (1 << j))
+            continue;
+
+        Keyboard.release(key.actuationOutputs[j].keyChar);
+        reportChanged = true;
+    }
+
+    // The actuation level covers the leading actuation points the key is still below. Actuation points the key was below that come after
+    // a new one are released and crossed again from scratch on the next sample, since the level only counts consecutive actuation points.
+    uint8_t level = 0;
+    while (level < count && crossed[level])
+        level++;
+    for (uint8_t i = level; i < count; i++)
+        if (crossed[i])
+            setOutput(key, outputs[i], false);
+
+    // Release the key char of the key itself if it is in the report once actuation points are enabled, since it is no longer reported then.
+    // The same goes for the hold of the key, which is discarded along with its tap-hold state. Keys without actuation points keep them.
+    if (key.actuationPointCount == 0 && count > 0)
+    {
+        setOutput(key, key.output, false);
+        setOutput(key, key.holdOutput, false);
+        scheduler.cancel(key.index);
+        key.tapHoldState = TapHoldState::Released;
+    }
+
+    // The key is pressed as long as it is below one of its actuation points. If the actuation points have been removed entirely, the
+    // hysteresis and rapid trigger logic take over from the released state.
+    if (key.actuationPointCount > 0 || count > 0)
+        key.pressed = level > 0;
+
+    key.actuationPointCount = count;
+    key.actuationLevel = level;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        key.actuationPoints[i] = points[i];
+        key.actuationReleaseDistances[i] = releaseDistances[i];
+        key.actuationOutputs[i] = outputs[i];
+    }
+}
+
+template <typename TBoard>
+bool BasicKeyHandler<TBoard>::isSameActuationPoint(const ActuationPoint &a, const ActuationPoint &b)
+{
+    return a.distance == b.distance && a.keyChar == b.keyChar && a.pressAction == b.pressAction && a.releaseAction == b.releaseAction;
+}
+
+#ifdef USE_GAUSS_CORRECTION_LUT
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::assignGaussLUTs()
+{
+    // Keep every key on its current table if that one is calculated for the gauss correction parameters of the key, so that a change
+    // of the curve of one key (e.g. after a gauss calibration) does not move the other keys to a table that has to be rebuilt first.
+    // The tables still in use are remembered as a bitmask of their indices in the pool.
+    uint8_t usedLUTs = 0;
+    for (HEKey &key : heKeys)
+    {
+        if (key.gaussLUT && key.gaussLUT->parameters == getGaussParameters(key))
+            usedLUTs |= 1 << (key.gaussLUT - gaussLUTs.data());
+        else
+            key.gaussLUT = nullptr;
+    }
+
+    // For the remaining keys, look for a table in use with the same parameters and share it if one is found, since every table takes up
+    // multiple kilobytes of memory and takes a while to calculate. Otherwise, the key takes an unused table, which is rebuilt for its
+    // parameters. If all tables of the pool are in use by other curves, the key falls back to the linear mapping.
+    for (HEKey &key : heKeys)
     {
-        // Scan the digital key to update the pin status.
-        scanDigitalKey(key);
+        if (key.gaussLUT)
+            continue;
+
+        GaussParameters parameters = getGaussParameters(key);
+        for (uint8_t i = 0; i < gaussLUTs.size() && !key.gaussLUT; i++)
+            if ((usedLUTs & (1 << i)) && gaussLUTs[i].parameters == parameters)
+                key.gaussLUT = &gaussLUTs[i];
+
+        for (uint8_t i = 0; i < gaussLUTs.size() && !key.gaussLUT; i++)
+        {
+            if (usedLUTs & (1 << i))
+                continue;
+
+            usedLUTs |= 1 << i;
+            key.gaussLUT = &gaussLUTs[i];
+            key.gaussLUT->setParameters(parameters);
+        }
 
-        // Run the checks on the digital key.
-        checkDigitalKey(key);
+        if (!key.gaussLUT)
+            LOG_WARN("no gauss lut left for key %d", key.index + 1);
     }
+}
+
+template <typename TBoard>
+GaussParameters BasicKeyHandler<TBoard>::getGaussParameters(const HEKey &key)
+{
+    // Use the curve fitted by a gauss calibration if there is one, otherwise the one of the board.
+    if (!key.config->customGauss)
+        return key.descriptor->gauss;
+
+    const float *parameters = key.config->gaussParameters;
+    return {parameters[0], parameters[1], parameters[2], parameters[3]};
+}
 
-    // Send the key report via the HID interface after updating the report.
-    Keyboard.sendReport();
+template <typename TBoard>
+bool BasicKeyHandler<TBoard>::startGaussCalibration(HEKey &key)
+{
+    // The calibration levels are spaced between the rest and the down position, so the key has to be calibrated first.
+    if (!key.calibrated)
+        return false;
+
+    gaussFitter.begin(key.index, key.restPosition, key.downPosition);
+    return true;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::resetGaussCalibration(HEKey &key)
+{
+    // Return to the curve of the board and rebuild the lookup tables accordingly.
+    key.config->customGauss = false;
+    assignGaussLUTs();
 }
 
-void KeyHandler::updateSensorBoundaries(HEKey &key)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateGaussCalibration()
+{
+    // If the sweep of a gauss calibration has been recorded, evaluate the next curvature candidate. Once the curve has been fitted,
+    // store the parameters in the configuration of the key and rebuild the lookup tables with them.
+    if (gaussFitter.state == GaussCalibrationState::Fitting)
+    {
+        gaussFitter.step();
+        if (gaussFitter.state == GaussCalibrationState::Done)
+        {
+            HEKeyConfig &config = *heKeys[gaussFitter.keyIndex].config;
+            const GaussParameters &parameters = gaussFitter.parameters;
+            config.gaussParameters[0] = parameters.a;
+            config.gaussParameters[1] = parameters.b;
+            config.gaussParameters[2] = parameters.c;
+            config.gaussParameters[3] = parameters.d;
+            config.customGauss = true;
+            assignGaussLUTs();
+        }
+    }
+
+    // Continue rebuilding the lookup tables that are not ready yet. Keys fall back to the linear mapping until their table is ready.
+    for (HEKey &key : heKeys)
+        if (key.gaussLUT && !key.gaussLUT->ready)
+            key.gaussLUT->buildStep();
+}
+#endif
+
+template <typename TBoard>
+bool BasicKeyHandler<TBoard>::startCrosstalkCalibration()
+{
+    // The readings of all keys at rest are the reference for the shifts, so all keys have to be calibrated and resting.
+    uint16_t values[TBoard::heKeyCount];
+    for (const HEKey &key : heKeys)
+    {
+        if (!key.calibrated || key.pressed || key.distance < TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD)
+            return false;
+
+        values[key.index] = key.rawValue;
+    }
+
+    crosstalkCalibrator.begin(values);
+    return true;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::resetCrosstalkCalibration()
+{
+    // Clear the crosstalk matrix, disabling the compensation.
+    memset(ConfigController.config.crosstalk, 0, sizeof(ConfigController.config.crosstalk));
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateCrosstalkCalibration()
+{
+    if (crosstalkCalibrator.state != CrosstalkCalibrationState::Recording)
+        return;
+
+    // Pass the readings and distances of all keys into the recording. Once every key has been pressed, apply the measured crosstalk matrix.
+    uint16_t values[TBoard::heKeyCount];
+    uint16_t distances[TBoard::heKeyCount];
+    for (const HEKey &key : heKeys)
+    {
+        values[key.index] = key.rawValue;
+        distances[key.index] = key.distance;
+    }
+
+    crosstalkCalibrator.update(values, distances);
+    if (crosstalkCalibrator.state == CrosstalkCalibrationState::Done)
+        memcpy(ConfigController.config.crosstalk, crosstalkCalibrator.coefficients, sizeof(ConfigController.config.crosstalk));
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::handle()
+{
+    // Reset the motion state, it is set again by the scans and checks of the keys below.
+    motionDetected = false;
+
+    // Every pass has a budget of one sample per Hall Effect key, which is distributed based on the activity of the keys. If no key is active,
+    // every key gets one sample. Otherwise, resting keys drop to a guaranteed minimum rate and the freed samples go to the active keys,
+    // giving the keys that are actually being played a higher effective sample rate without requiring a faster ADC.
+    bool anyActive = false;
+    for (const HEKey &key : heKeys)
+        anyActive |= key.active;
+
+    uint8_t budget = TBoard::heKeyCount;
+    for (HEKey &key : heKeys)
+    {
+        // Skip resting keys until they are due again while other keys are active.
+        if (anyActive && !key.active && ++key.skippedScans < SCAN_RESTING_KEY_INTERVAL)
+            continue;
+
+        sampleHEKey(key);
+        budget--;
+    }
+
+    // Spend the remaining samples on the active keys, continuing the round-robin where the last pass stopped so that the extra samples are
+    // distributed evenly. The amount of iterations is bounded in case the keys stop being active while they are sampled.
+    for (uint8_t i = 0; anyActive && budget > 0 && i < TBoard::heKeyCount * TBoard::heKeyCount; i++)
+    {
+        HEKey &key = heKeys[nextPriorityKey];
+        nextPriorityKey = (nextPriorityKey + 1) % TBoard::heKeyCount;
+        if (!key.active)
+            continue;
+
+        sampleHEKey(key);
+        budget--;
+    }
+
+#ifdef USE_GAUSS_CORRECTION_LUT
+    // Advance the gauss calibration and the rebuilding of the lookup tables by one step.
+    updateGaussCalibration();
+#endif
+
+    // Pass the readings of this pass into the crosstalk calibration, if one is running.
+    updateCrosstalkCalibration();
+
+    // Go through all digital keys and run the checks. On boards without digital keys, this is compiled away entirely.
+    if constexpr (TBoard::digitalKeyCount > 0)
+    {
+        for (DigitalKey &key : digitalKeys)
+        {
+            // Scan the digital key to update the pin status.
+            scanDigitalKey(key);
+
+            // Run the checks on the digital key.
+            checkDigitalKey(key);
+        }
+    }
+
+    // Resolve the SOCD groups and queue the resulting key states for the report. This is done after all keys have been checked,
+    // so that a switch between two keys of a group lands in a single report, without any report where both are pressed. If the losing key
+    // still has a release queued from an earlier edge, the press of the winner follows one report later. (see getBlockedSOCDPresses)
+    updateReport(resolveSOCD());
+
+    // Send the next queued edges via the HID interface, if the last report has been picked up by the host.
+    sendReport();
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::sampleHEKey(HEKey &key)
+{
+    // Scan the Hall Effect key to update the sensor and distance value.
+    scanHEKey(key);
+
+    // Run the checks on the HE key.
+    checkHEKey(key);
+
+    // Update the activity of the key for the scheduling of the samples. A key is active if it is moving, pressed, inside the rapid trigger
+    // zone or close to one of the hysteresis thresholds, since these are the situations in which a sample can cause an actuation.
+    key.active = key.moving || key.pressed || key.inRapidTriggerZone ||
+                 abs(key.distance - key.config->lowerHysteresis) <= SCAN_PRIORITY_THRESHOLD_DISTANCE ||
+                 abs(key.distance - key.config->upperHysteresis) <= SCAN_PRIORITY_THRESHOLD_DISTANCE;
+
+    // With actuation points, the thresholds are the next actuation point to cross downwards and the release distance of the last
+    // crossed one, since the actuation level only ever moves between these two.
+    if (key.actuationLevel < key.actuationPointCount)
+        key.active |= abs(key.distance - key.actuationPoints[key.actuationLevel].distance) <= SCAN_PRIORITY_THRESHOLD_DISTANCE;
+    if (key.actuationLevel > 0)
+        key.active |= abs(key.distance - key.actuationReleaseDistances[key.actuationLevel - 1]) <= SCAN_PRIORITY_THRESHOLD_DISTANCE;
+    key.skippedScans = 0;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateSensorBoundaries(HEKey &key)
 {
     // Calculate the value with the deadzone in the positive and negative direction applied.
-    uint16_t upperValue = key.rawValue - SENSOR_BOUNDARY_DEADZONE;
-    uint16_t lowerValue = key.rawValue + SENSOR_BOUNDARY_DEADZONE;
+    uint16_t upperValue = key.rawValue - key.config->sensorBoundaryDeadzone;
+    uint16_t lowerValue = key.rawValue + key.config->sensorBoundaryDeadzone;
+
+    // If drift tracking is enabled and the key is calibrated, the boundaries are no longer only widened but tracked continuously.
+    if (key.config->driftTracking && key.calibrated)
+    {
+        trackSensorDrift(key);
+        return;
+    }
 
     // If the read value with deadzone applied is bigger than the current rest position, update it.
     if (key.restPosition < upperValue)
+    {
         key.restPosition = upperValue;
+        LOG_DEBUG("hkey%d rest position %u", key.index + 1, key.restPosition);
+    }
 
     // If the read value with deadzone applied is lower than the current down position, update it. Make sure that the distance to the rest position
     // is at least SENSOR_BOUNDARY_MIN_DISTANCE (scaled with travel distance @ 4.00mm) to prevent poor calibration/analog range resulting in "crazy behaviour".
@@ -93,32 +459,166 @@ void KeyHandler::updateSensorBoundaries(HEKey &key)
              key.restPosition - lowerValue >= SENSOR_BOUNDARY_MIN_DISTANCE * TRAVEL_DISTANCE_IN_0_01MM / 400)
     {
         // From here on, the down position has been set < rest position, therefore the key can be considered calibrated, allowing distance calculation.
+        if (!key.calibrated)
+            LOG_INFO("hkey%d calibrated, rest position %u", key.index + 1, key.restPosition);
         key.calibrated = true;
 
         key.downPosition = lowerValue;
+        LOG_DEBUG("hkey%d down position %u", key.index + 1, key.downPosition);
     }
 }
 
-void KeyHandler::scanHEKey(HEKey &key)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::trackSensorDrift(HEKey &key)
 {
-    // Read the value from the port of the specified key and run it through the SMA filter.
-    key.rawValue = key.filter(analogRead(HE_PIN(key.index)));
+    // Temperature drift shifts the readings of the sensor over time. If the rest and down position were only ever widened, the calibrated range
+    // would grow with every drift or peak, distorting the distance mapping until reboot. Instead, the peaks of the readings while resting
+    // and while fully pressed are tracked with slowly decaying envelopes, rejecting outliers, and the boundaries follow these envelopes.
+    uint16_t deadzone = key.config->sensorBoundaryDeadzone;
+
+    // If the key is resting, update the rest envelope. The envelope starts at the calibrated rest position on the first update.
+    if (!key.pressed && key.distance >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD)
+    {
+        if (!key.restTracker.initialized)
+            key.restTracker.reset(key.restPosition + deadzone);
+
+        if (!key.restTracker.update(key.rawValue, deadzone))
+            return;
+
+        // If the tracked rest position moved far enough, recalibrate. Since drift mostly offsets the readings as a whole, the down
+        // position is shifted by the same amount, keeping the range until it is tracked again the next time the key is fully pressed.
+        int16_t delta = (key.restTracker.get() - deadzone) - key.restPosition;
+        if (abs(delta) >= DRIFT_TRACKING_HYSTERESIS && key.downPosition + delta >= 0)
+        {
+            key.restPosition += delta;
+            key.downPosition += delta;
+            if (key.downTracker.initialized)
+                key.downTracker.reset(key.downPosition - deadzone);
+
+            key.recalibrations++;
+            LOG_INFO("hkey%d drift of %d, rest position %u, down position %u", key.index + 1, delta, key.restPosition, key.downPosition);
+        }
+    }
+
+    // If the key is fully pressed, update the down envelope. The envelope starts at the calibrated down position on the first update.
+    else if (key.distance <= DRIFT_TRACKING_DOWN_THRESHOLD)
+    {
+        if (!key.downTracker.initialized)
+            key.downTracker.reset(key.downPosition - deadzone);
+
+        if (!key.downTracker.update(key.rawValue, deadzone))
+            return;
 
-    // Invert the value if the definition is set since in rare fields of application the sensor
+        // If the tracked down position moved far enough, recalibrate. The minimum distance to the rest position is still maintained.
+        uint16_t downPosition = key.downTracker.get() + deadzone;
+        if (abs(downPosition - key.downPosition) >= DRIFT_TRACKING_HYSTERESIS &&
+            key.restPosition - downPosition >= SENSOR_BOUNDARY_MIN_DISTANCE * TRAVEL_DISTANCE_IN_0_01MM / 400)
+        {
+            key.downPosition = downPosition;
+            key.recalibrations++;
+            LOG_INFO("hkey%d drift, down position %u", key.index + 1, key.downPosition);
+        }
+    }
+}
+
+template <typename TBoard>
+uint16_t BasicKeyHandler<TBoard>::compensateCrosstalk(const HEKey &key, uint16_t value)
+{
+    // The crosstalk is measured on the uncompensated readings, so the compensation is paused during a crosstalk calibration.
+    // On boards with a single Hall Effect key, there is no crosstalk and this is compiled away entirely.
+    if (TBoard::heKeyCount < 2 || crosstalkCalibrator.state == CrosstalkCalibrationState::Recording)
+        return value;
+
+    // Sum up the coupling of all other keys in Q15 fixed-point, being their deflection weighted by the row of this key in the crosstalk matrix.
+    // The deflection of a key is how far its filtered reading dropped below its reading at rest, which is the rest position plus the deadzone.
+    // The coefficients are bounded so that this sum fits into 32 bits. (see CROSSTALK_MAX_COEFFICIENT)
+    const int16_t *row = ConfigController.config.crosstalk[key.index];
+    int32_t coupling = 0;
+    for (const HEKey &other : heKeys)
+    {
+        int32_t deflection = other.restPosition + other.config->sensorBoundaryDeadzone - other.rawValue;
+        if (other.calibrated && deflection > 0)
+            coupling += row[other.index] * deflection;
+    }
+
+    // Add the shift caused by the other keys back onto the reading. The coefficient of the key itself is always zero.
+    return constrain(value + (coupling >> 15), 0, (1 << SENSOR_RESOLUTION) - 1);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::scanHEKey(HEKey &key)
+{
+    // If the sensor of the key is routed through a multiplexer, select its channel and give the signal time to settle.
+    // On boards without multiplexers, this is compiled away entirely.
+    if constexpr (TBoard::muxSelectPinCount > 0)
+    {
+        if (key.descriptor->muxChannel != NO_MUX)
+        {
+            for (uint8_t i = 0; i < TBoard::muxSelectPinCount; i++)
+                digitalWrite(board->muxSelectPins[i], (key.descriptor->muxChannel >> i) & 1);
+
+            delayMicroseconds(MUX_SETTLE_TIME_US);
+        }
+    }
+
+    // Read the value from the port of the specified key, oversampled and decimated into the sensor resolution.
+    uint16_t value = ADCHelper::readOversampled(key.descriptor->pin, key.config->oversamplingExponent);
+    key.sampleTime = micros();
+
+    // Invert the value if the descriptor of the key says so, since in rare fields of application the sensor
     // is mounted the other way around, resulting in a different polarity and inverted sensor readings.
     // Since this firmware expects the value to go down when the button is pressed down, this is needed.
-#ifdef INVERT_SENSOR_READINGS
-    key.rawValue = (1 << ANALOG_RESOLUTION) - 1 - key.rawValue;
+    if (key.descriptor->invertReadings)
+        value = (1 << SENSOR_RESOLUTION) - 1 - value;
+
+    // Remove the shift caused by the magnets of the neighbouring keys before the value is filtered and used for the sensor boundaries.
+    value = compensateCrosstalk(key, value);
+
+    // If the configured filter depth changed (e.g. through auto-tuning), replace the SMA filter of the key with a new one. The new filter
+    // is filled with the current reading, since an empty one would ramp up from 0, which reads as the key being pressed down fully.
+    if (key.filter.getSamplesExponent() != key.config->smaFilterSampleExponent)
+    {
+        key.filter = SMAFilter(key.config->smaFilterSampleExponent);
+        key.filter.fill(value);
+    }
+
+    // If the unfiltered value left the noise band around the filtered one, the key is moving. The noise band is the peak-to-peak
+    // range measured at rest but at least the deadzone, so a key that has not been measured yet does not wake the keypad up on noise.
+    uint16_t noiseBand = max(key.rawNoise.peakToPeak, key.config->sensorBoundaryDeadzone);
+    key.moving = abs(value - key.rawValue) > noiseBand;
+    if (key.moving || key.pressed)
+        motionDetected = true;
+
+    // Run the value through the SMA filter.
+    key.rawValue = key.filter(value);
+
+#ifdef USE_GAUSS_CORRECTION_LUT
+    // If the key is being calibrated, pass the filtered value into the recording of the sweep.
+    if (gaussFitter.state == GaussCalibrationState::Recording && gaussFitter.keyIndex == key.index)
+        gaussFitter.update(key.rawValue);
 #endif
 
+    // If the key was resting on the last scan, pass the unfiltered and filtered value into the noise statistics. If the key
+    // moved, discard the current windows since the statistics should only contain the noise and not the movement of the key.
+    if (key.calibrated && !key.pressed && key.distance >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD)
+    {
+        key.rawNoise.add(value);
+        key.filteredNoise.add(key.rawValue);
+    }
+    else
+    {
+        key.rawNoise.discard();
+        key.filteredNoise.discard();
+    }
+
     // If the SMA filter is fully initalized (at least one full circular buffering has been performed), calibration can be performed.
     // This keeps track of the lowest and highest value reached on each key, giving us boundaries to map to an actual milimeter distance.
     if (key.filter.initialized)
         updateSensorBoundaries(key);
 
-    // Make sure that the key is calibrated, which means that the down position (default 4095) was updated to be  smaller than the rest position.
+    // Make sure that the key is calibrated, which means that the down position (default: the maximum sensor value) was updated to be  smaller than the rest position.
     // If that's not the case, we go with the total switch travel distance representing a key that is fully up, effectively disabling any value processing.
-    // This if-branch is inheritly triggered if the SMA filter is not initialized yet, as the default down position of 4095 was not updated yet.
+    // This if-branch is inheritly triggered if the SMA filter is not initialized yet, as the default down position was not updated yet.
     if(!key.calibrated)
     {
         key.distance = TRAVEL_DISTANCE_IN_0_01MM;
@@ -129,31 +629,97 @@ void KeyHandler::scanHEKey(HEKey &key)
 
     // If gauss correction is enabled, use the GaussLUT instance to get the distance based on the adc value and the rest position
     // of the key, which is used to determine the offset from the "ideal" rest position set by the lookup table calculations.
-    uint16_t distance = gaussLUT.adcToDistance(key.rawValue, key.restPosition);
+    // If the lookup table is being rebuilt, e.g. after a gauss calibration, fall back to the linear mapping below until it is ready.
+    // The same goes for keys without a table, since the pool of tables only covers a limited amount of distinct curves.
+    if (key.gaussLUT && key.gaussLUT->ready)
+    {
+        uint16_t distance = key.gaussLUT->adcToDistance(key.rawValue, key.restPosition);
 
-    // Stretch the value to the full travel distance using our down position since the LUT is rest-position based. Then invert and constrain it.
-    distance = distance * TRAVEL_DISTANCE_IN_0_01MM / gaussLUT.adcToDistance(key.downPosition, key.restPosition);
-    key.distance = constrain(TRAVEL_DISTANCE_IN_0_01MM - distance, 0, TRAVEL_DISTANCE_IN_0_01MM);
+        // Stretch the value to the full travel distance using our down position since the LUT is rest-position based. Then invert and constrain it.
+        distance = distance * TRAVEL_DISTANCE_IN_0_01MM / key.gaussLUT->adcToDistance(key.downPosition, key.restPosition);
+        key.distance = constrain(TRAVEL_DISTANCE_IN_0_01MM - distance, 0, TRAVEL_DISTANCE_IN_0_01MM);
+        return;
+    }
 
-#else
+#endif
 
     // Map the value with the down and rest position values to a range between 0 and TRAVEL_DISTANCE_IN_0_01MM and constrain it.
     // This is done to guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
     // NOTE: This calcuation disregards the non-linear nature of the relation between a magnet's distance and it's magnetic field strength.
     //       This firmware has a gauss correction, which can be enabled and adjusted to match the hardware specifications of the device.
-    return constrain(map(value, key.downPosition, key.restPosition, 0, TRAVEL_DISTANCE_IN_0_01MM), 0, TRAVEL_DISTANCE_IN_0_01MM);
+    key.distance = constrain(map(key.rawValue, key.downPosition, key.restPosition, 0, TRAVEL_DISTANCE_IN_0_01MM), 0, TRAVEL_DISTANCE_IN_0_01MM);
+}
 
-#endif
+template <typename TBoard>
+bool BasicKeyHandler<TBoard>::autoTune(HEKey &key)
+{
+    // Auto-tuning requires the key to be calibrated and at least one noise window to have been completed at rest.
+    if (!key.calibrated || !key.rawNoise.valid)
+        return false;
+
+    // Find the smallest filter depth that brings the standard deviation of the readings below the target. Averaging 2^n samples
+    // reduces the variance of uncorrelated noise by 2^n, which is compared here to get around calculating square roots.
+    uint64_t variance = (uint64_t)key.rawNoise.standardDeviation * key.rawNoise.standardDeviation;
+    uint64_t targetVariance = (uint64_t)(AUTO_TUNE_TARGET_NOISE * 256 / 100) * (AUTO_TUNE_TARGET_NOISE * 256 / 100);
+    uint8_t exponent = 0;
+    while (exponent < SMA_FILTER_MAX_SAMPLE_EXPONENT && (variance >> exponent) > targetVariance)
+        exponent++;
+
+    // Estimate the peak-to-peak range of the filtered readings with the new filter depth. If the filter depth does not change,
+    // also take the measured range into account since the noise might be correlated and not be reduced as much by the filter.
+    uint32_t filteredDeviation = NoiseStats::sqrt(variance >> exponent);
+    uint16_t peakToPeak = (AUTO_TUNE_NOISE_SIGMAS * filteredDeviation + 255) >> 8;
+    if (exponent == key.filter.getSamplesExponent() && key.filteredNoise.valid && key.filteredNoise.peakToPeak > peakToPeak)
+        peakToPeak = key.filteredNoise.peakToPeak;
+
+    // The deadzone has to cover the whole range the filtered readings fluctuate in at rest, otherwise the key would not reach
+    // a distance of 0 at rest. One additional count is added to account for rounding.
+    uint16_t deadzone = constrain(peakToPeak + 1, 1, UINT16_MAX);
+
+    // Convert the fluctuation into a distance by linearly approximating the travel distance per ADC count on the calibrated range.
+    // The rapid trigger sensitivities should never be small enough for the fluctuation to trigger the key on its own.
+    uint32_t range = key.restPosition - key.downPosition;
+    uint32_t tolerance = (AUTO_TUNE_SAFETY_FACTOR * peakToPeak * TRAVEL_DISTANCE_IN_0_01MM + range - 1) / range;
+    tolerance = constrain(tolerance, AUTO_TUNE_MIN_RAPID_TRIGGER_TOLERANCE, TRAVEL_DISTANCE_IN_0_01MM);
+
+    // Apply the derived values to the configuration of the key.
+    key.config->sensorBoundaryDeadzone = deadzone;
+    key.config->smaFilterSampleExponent = exponent;
+    key.config->rapidTriggerTolerance = tolerance;
+
+    // Make sure the rapid trigger sensitivities are still within the (possibly raised) tolerance.
+    if (key.config->rapidTriggerUpSensitivity < tolerance)
+        key.config->rapidTriggerUpSensitivity = tolerance;
+    if (key.config->rapidTriggerDownSensitivity < tolerance)
+        key.config->rapidTriggerDownSensitivity = tolerance;
+
+    return true;
 }
 
-void KeyHandler::scanDigitalKey(DigitalKey &key)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::scanDigitalKey(DigitalKey &key)
 {
     // Read the digital key and save the pin status in the key.
-    key.isHigh = digitalRead(DIGITAL_PIN(key.index)) == PinStatus::HIGH;
+    key.isHigh = digitalRead(key.descriptor->pin) == PinStatus::HIGH;
+    key.sampleTime = micros();
+
+    // A digital key being pressed keeps the keypad awake.
+    if (key.isHigh)
+        motionDetected = true;
 }
 
-void KeyHandler::checkHEKey(HEKey &key)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::checkHEKey(HEKey &key)
 {
+    // If the key has actuation points, they replace the hysteresis and rapid trigger logic. They are only evaluated once the key
+    // is calibrated, since the distance of an uncalibrated key does not reflect its actual travel.
+    if (key.actuationPointCount > 0)
+    {
+        if (key.calibrated)
+            checkActuationPoints(key);
+        return;
+    }
+
     // If the key is in traditional mode, do the usual hysteresis checks.
     if (!key.config->rapidTrigger)
     {
@@ -174,10 +740,24 @@ void KeyHandler::checkHEKey(HEKey &key)
     // meaning the rapid trigger state for the key has to be set to false in order to be processed by further checks.
     // This only applies if continuous rapid trigger is not enabled as it only resets the state when the key is fully released.
     if (key.distance >= key.config->upperHysteresis && !key.config->continuousRapidTrigger)
+    {
+        if (key.inRapidTriggerZone)
+            LOG_DEBUG("hkey%d left rapid trigger zone at %d", key.index + 1, key.distance);
+
         key.inRapidTriggerZone = false;
+    }
     // If continuous rapid trigger is enabled, the state is only reset to false when the key is fully released (<0.1mm).
     else if (key.distance >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD && key.config->continuousRapidTrigger)
+    {
+        // Count the reset in the statistics of the key if the key actually left the rapid trigger zone.
+        if (key.inRapidTriggerZone)
+        {
+            key.statistics->continuousRapidTriggerResets++;
+            LOG_DEBUG("hkey%d left continuous rapid trigger zone at %d", key.index + 1, key.distance);
+        }
+
         key.inRapidTriggerZone = false;
+    }
 
     // RT STEP 2: If the value entered the rapid trigger zone, perform a press and set the rapid trigger state to true.
     // If the value is below the lower hysteresis and the rapid trigger state is false on the key, press the key because the action of entering
@@ -187,17 +767,30 @@ void KeyHandler::checkHEKey(HEKey &key)
     {
         setPressedState(key, true);
         key.inRapidTriggerZone = true;
+        LOG_DEBUG("hkey%d entered rapid trigger zone at %d", key.index + 1, key.distance);
     }
 
     // RT STEP 3: If the key *already is* in the rapid trigger zone (hence the 'else if'), check whether the key has travelled the sufficient amount.
     // Check whether the key should be pressed. This is the case if the key is currently not pressed,
     // the rapid trigger state is true and the value drops more than (down sensitivity) below the highest recorded value.
     else if (!key.pressed && key.inRapidTriggerZone && key.distance + key.config->rapidTriggerDownSensitivity <= key.rapidTriggerPeak)
+    {
         setPressedState(key, true);
+
+        // Count the re-trigger in the statistics of the key if the press actually happened.
+        if (key.pressed)
+        {
+            key.statistics->rapidTriggers++;
+            LOG_DEBUG("hkey%d rapid trigger press at %d, peak %d", key.index + 1, key.distance, key.rapidTriggerPeak);
+        }
+    }
     // Check whether the key should be released. This is the case if the key is currently pressed down and either the
     // rapid trigger state is no longer true or the value rises more than (up sensitivity) above the lowest recorded value.
     else if (key.pressed && (!key.inRapidTriggerZone || key.distance >= key.rapidTriggerPeak + key.config->rapidTriggerUpSensitivity))
+    {
         setPressedState(key, false);
+        LOG_DEBUG("hkey%d rapid trigger release at %d, peak %d", key.index + 1, key.distance, key.rapidTriggerPeak);
+    }
 
     // RT STEP 4: Always remember the peaks of the values, depending on the current pressed state.
     // If the key is pressed and at an all-time low or not pressed and at an all-time high, save the value.
@@ -205,7 +798,62 @@ void KeyHandler::checkHEKey(HEKey &key)
         key.rapidTriggerPeak = key.distance;
 }
 
-void KeyHandler::checkDigitalKey(DigitalKey &key)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::checkActuationPoints(HEKey &key)
+{
+    // Cross the actuation points downwards as long as the key is below the next one, performing their press actions. The actuation level
+    // remembers how many actuation points the key is below, so only the neighbouring distances have to be checked. Since the amount of
+    // actuation points is limited, both loops are bounded and the evaluation stays constant-time per key.
+    while (key.actuationLevel < key.actuationPointCount && key.distance <= key.actuationPoints[key.actuationLevel].distance)
+    {
+        performAction(key, key.actuationLevel, key.actuationPoints[key.actuationLevel].pressAction);
+        key.actuationLevel++;
+    }
+
+    // Cross the actuation points upwards as long as the key is above the release distance of the last crossed one, performing their release actions.
+    while (key.actuationLevel > 0 && key.distance >= key.actuationReleaseDistances[key.actuationLevel - 1])
+    {
+        key.actuationLevel--;
+        performAction(key, key.actuationLevel, key.actuationPoints[key.actuationLevel].releaseAction);
+    }
+
+    // The key is considered pressed as long as it is below at least one actuation point. Changes are counted in the statistics of the key.
+    if (key.pressed != (key.actuationLevel > 0))
+        recordTransition(key, key.actuationLevel > 0);
+
+    key.pressed = key.actuationLevel > 0;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::performAction(HEKey &key, uint8_t point, ActuationAction action)
+{
+    // Just like with the pressed state, presses are only sent if HID is enabled while releases are always sent,
+    // in case it is being deactivated while a key is still held down.
+    KeyOutput &output = key.actuationOutputs[point];
+    switch (action)
+    {
+    case ActuationAction::Press:
+        if (key.config->hidEnabled)
+            setOutput(key, output, true);
+        break;
+
+    case ActuationAction::Release:
+        setOutput(key, output, false);
+        break;
+
+    // For taps, both the press and the release are queued, so they are sent with two consecutive reports.
+    case ActuationAction::Tap:
+        if (key.config->hidEnabled)
+            tapOutput(key, output);
+        break;
+
+    default:
+        break;
+    }
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::checkDigitalKey(DigitalKey &key)
 {
     // Check whether the pin status on the key is HIGH and the key is fully debounced.
     if (key.isHigh && millis() - key.lastDebounce >= DIGITAL_DEBOUNCE_DELAY)
@@ -219,19 +867,434 @@ void KeyHandler::checkDigitalKey(DigitalKey &key)
         setPressedState(key, false);
 }
 
-void KeyHandler::setPressedState(Key &key, bool pressed)
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::setPressedState(Key &key, bool pressed)
 {
     // Check whether either the pressed state changes or HID is not enabled and a press is performed.
     // HID may not be blocked on releases in case it is being deactivated while a key is still held down.
     if (key.pressed == pressed || (!key.config->hidEnabled && pressed))
         return;
 
-    // Send the HID instruction to the computer.
+    // Remember the order of the presses for the SOCD resolution.
     if (pressed)
-        Keyboard.press(key.config->keyChar);
-    else
-        Keyboard.release(key.config->keyChar);
+        key.pressSequence = ++pressSequence;
+
+    // Count the press or release in the statistics of the key.
+    recordTransition(key, pressed);
 
-    // Update the pressed value state.
+    // Update the pressed value state. The HID report is updated with it once all keys have been checked.
     key.pressed = pressed;
 }
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::recordTransition(Key &key, bool pressed)
+{
+    KeyStatistics &statistics = *key.statistics;
+
+    // On a press, count it and remember the time for the duration of the press.
+    if (pressed)
+    {
+        statistics.presses++;
+        key.pressTime = micros();
+        return;
+    }
+
+    // On a release, count it and sort the duration of the press into the histogram, bucket n covering 2^n to 2^(n+1) milliseconds.
+    // Presses shorter than the chatter threshold are counted separately, since they indicate a bouncing switch or a noisy sensor.
+    statistics.releases++;
+    uint32_t duration = (micros() - key.pressTime) / 1000;
+    if (duration < ConfigController.config.chatterThreshold)
+        statistics.chatters++;
+
+    uint8_t bucket = duration < 2 ? 0 : 31 - __builtin_clz(duration);
+    statistics.durations[min(bucket, (uint8_t)(KEY_STATISTICS_DURATION_BUCKETS - 1))]++;
+}
+
+template <typename TBoard>
+uint16_t BasicKeyHandler<TBoard>::resolveSOCD()
+{
+    // The Hall Effect keys that are not sent due to the SOCD resolution, as a bitmask.
+    uint16_t suppressed = 0;
+
+    for (uint8_t i = 0; i < SOCD_GROUPS; i++)
+    {
+        const SOCDGroup &group = ConfigController.config.socdGroups[i];
+        if (group.mode == SOCDMode::Off)
+            continue;
+
+        // Find the keys of the group that are currently pressed. Keys with actuation points are not part of the resolution since they
+        // do not send their own key char. The current winner of the group is only replaced if another key wins by the rules of the mode.
+        uint16_t pressed = 0;
+        for (const HEKey &key : heKeys)
+            if ((group.keys & (1 << key.index)) && key.pressed && key.actuationPointCount == 0)
+                pressed |= 1 << key.index;
+
+        // If less than two keys are pressed, there is nothing to resolve.
+        if ((pressed & (pressed - 1)) == 0)
+            continue;
+
+        // In neutral mode, none of the keys are sent.
+        if (group.mode == SOCDMode::Neutral)
+        {
+            suppressed |= pressed;
+            continue;
+        }
+
+        // Otherwise, find the winner of the group. For the deepest travel, the key currently in the report is kept unless another key is pressed
+        // further down by more than its rapid trigger tolerance, so that two keys pressed down equally far do not constantly switch due to the fluctuation.
+        const HEKey *winner = nullptr;
+        for (const HEKey &key : heKeys)
+            if ((pressed & (1 << key.index)) && (winner == nullptr || (group.mode == SOCDMode::DeepestTravel && key.output.getTarget())))
+                winner = &key;
+
+        for (const HEKey &key : heKeys)
+        {
+            if (!(pressed & (1 << key.index)))
+                continue;
+
+            if ((group.mode == SOCDMode::LastInput && key.pressSequence > winner->pressSequence) ||
+                (group.mode == SOCDMode::FirstInput && key.pressSequence < winner->pressSequence) ||
+                (group.mode == SOCDMode::DeepestTravel && key.distance + key.config->rapidTriggerTolerance < winner->distance))
+                winner = &key;
+        }
+
+        suppressed |= pressed & ~(1 << winner->index);
+    }
+
+    return suppressed;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateReport(uint16_t suppressed)
+{
+    // Update the modes of all keys first, since the layer keys switch the layer the key chars of the other keys are taken from. Keys with
+    // actuation points are skipped since they update the report with their own key chars. Tap-hold keys on Hall Effect sensors also perform
+    // the hold once they are pressed down below their hold distance. The momentary layers are collected from scratch on every update.
+    momentaryLayers = 0;
+    for (HEKey &key : heKeys)
+    {
+        if (key.actuationPointCount > 0)
+            continue;
+
+        updateKeyMode(key, key.index, key.pressed && !(suppressed & (1 << key.index)),
+                      key.config->holdDistance > 0 && key.distance <= key.config->holdDistance);
+    }
+
+    for (DigitalKey &key : digitalKeys)
+        updateKeyMode(key, TBoard::heKeyCount + key.index, key.pressed, false);
+
+    // Perform the holds of the tap-hold keys that have been held down past their hold time. Keys released in the meantime have already
+    // cancelled their hold above, so a tap is never turned into a hold late.
+    uint8_t id;
+    while (scheduler.pop(millis(), id))
+    {
+        if (id < TBoard::heKeyCount)
+            performHold(heKeys[id], id);
+        else
+            performHold(digitalKeys[id - TBoard::heKeyCount], id);
+    }
+
+    // The active layer is the highest layer that is either held or toggled on.
+    uint8_t layers = momentaryLayers | toggledLayers;
+    activeLayer = layers == 0 ? 0 : 31 - __builtin_clz(layers);
+
+    // Tap the key chars of the tap-hold keys released before their hold. This happens after the active layer has been updated, so that
+    // a tap released in the same update as a layer change already uses the key char of the new layer.
+    for (HEKey &key : heKeys)
+        if (tappedKeys & (1UL << key.index))
+            performTap(key);
+    for (DigitalKey &key : digitalKeys)
+        if (tappedKeys & (1UL << (TBoard::heKeyCount + key.index)))
+            performTap(key);
+    tappedKeys = 0;
+
+    // Queue the pressed state of all Hall Effect keys in normal mode for the HID report, except the ones suppressed by the SOCD resolution.
+    // These keys do not depend on the scheduler, so their state goes into the report right away, just like without the key modes.
+    // A suppressed key drops its queued edges except for a pending release, since an older backlog (e.g. from a fast rapid trigger tap)
+    // would otherwise keep pressing the key in the reports after the winner of its group has been pressed.
+    for (HEKey &key : heKeys)
+    {
+        if (key.actuationPointCount > 0 || key.config->mode != KeyMode::Normal)
+            continue;
+
+        if ((suppressed & (1 << key.index)) && key.output.queuedEdges > key.output.reported)
+        {
+            coalescedEdges += key.output.queuedEdges - key.output.reported;
+            key.output.queuedEdges = key.output.reported;
+        }
+
+        updateOutput(key, key.pressed && !(suppressed & (1 << key.index)));
+    }
+
+    // Queue the pressed state of all digital keys in normal mode for the HID report.
+    for (DigitalKey &key : digitalKeys)
+        if (key.config->mode == KeyMode::Normal)
+            updateOutput(key, key.pressed);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateKeyMode(Key &key, uint8_t id, bool pressed, bool holdReached)
+{
+    // Detect whether the key has been pressed or released since the last update.
+    bool press = pressed && !key.lastPressed;
+    bool release = !pressed && key.lastPressed;
+    key.lastPressed = pressed;
+
+    switch (key.config->mode)
+    {
+    case KeyMode::TapHold:
+        // On a press, schedule the hold for when the hold time has passed.
+        if (press)
+        {
+            key.tapHoldState = TapHoldState::Pending;
+            if (!scheduler.schedule(id, millis() + key.config->holdTime))
+                performHold(key, id);
+        }
+
+        // On a release, cancel the scheduled hold. If the hold has not been performed yet, the key has been tapped, so its key char is tapped
+        // once the active layer of this update is known. (see performTap) Otherwise, the hold ends.
+        else if (release)
+        {
+            scheduler.cancel(id);
+            if (key.tapHoldState == TapHoldState::Pending)
+                tappedKeys |= 1UL << id;
+            else if (key.tapHoldState == TapHoldState::Held)
+                setOutput(key, key.holdOutput, false);
+
+            key.tapHoldState = TapHoldState::Released;
+        }
+
+        // While the hold is performed without a hold key char, the layer of the key is held.
+        else if (key.tapHoldState == TapHoldState::Held && key.config->holdKeyChar == '\0')
+            momentaryLayers |= 1 << key.config->layer;
+
+        // If the key has been pressed down below its hold distance, perform the hold right away.
+        if (holdReached && key.tapHoldState == TapHoldState::Pending)
+            performHold(key, id);
+        break;
+
+    // Hold the layer of the key while it is pressed.
+    case KeyMode::MomentaryLayer:
+        if (pressed)
+            momentaryLayers |= 1 << key.config->layer;
+        break;
+
+    // Toggle the layer of the key on every press.
+    case KeyMode::ToggleLayer:
+        if (press)
+            toggledLayers ^= 1 << key.config->layer;
+        break;
+
+    default:
+        break;
+    }
+
+    // If the key left the tap-hold mode while it was pressed (e.g. through a configuration change), discard its hold.
+    if (key.config->mode != KeyMode::TapHold && key.tapHoldState != TapHoldState::Released)
+    {
+        scheduler.cancel(id);
+        setOutput(key, key.holdOutput, false);
+        key.tapHoldState = TapHoldState::Released;
+    }
+
+    // Keys in any mode other than the normal one never hold their own key char. Taps are not affected, since they are released already.
+    if (key.config->mode != KeyMode::Normal)
+        setOutput(key, key.output, false);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::performTap(Key &key)
+{
+    // Tap the key char of the active layer, sending the press with the next report and the release with the one after. The key char
+    // of the output is only switched if it is not in the report and has no queued edges, which would otherwise be sent with the wrong one.
+    if (!key.output.reported && key.output.queuedEdges == 0)
+        key.output.keyChar = getKeyChar(key);
+    tapOutput(key, key.output);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::performHold(Key &key, uint8_t id)
+{
+    scheduler.cancel(id);
+    key.tapHoldState = TapHoldState::Held;
+
+    // Press the hold key char if one is set. Otherwise, hold the layer of the key.
+    if (key.config->holdKeyChar != '\0')
+    {
+        if (!key.holdOutput.reported && key.holdOutput.queuedEdges == 0)
+            key.holdOutput.keyChar = key.config->holdKeyChar;
+        setOutput(key, key.holdOutput, true);
+    }
+    else
+        momentaryLayers |= 1 << key.config->layer;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::updateOutput(Key &key, bool pressed)
+{
+    // The key char of the output is updated while it is idle, so a changed key char or layer is used from the next press on
+    // and the release of a key char held while the layer changes still matches its press.
+    if (!key.output.reported && key.output.queuedEdges == 0)
+        key.output.keyChar = getKeyChar(key);
+    setOutput(key, key.output, pressed);
+}
+
+template <typename TBoard>
+char BasicKeyHandler<TBoard>::getKeyChar(const Key &key)
+{
+    // Use the key char of the active layer. If the key has no key char on that layer, fall through to the next lower layer.
+    for (uint8_t layer = activeLayer; layer > 0; layer--)
+        if (key.config->layerKeyChars[layer - 1] != '\0')
+            return key.config->layerKeyChars[layer - 1];
+
+    return key.config->keyChar;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::setOutput(const Key &key, KeyOutput &output, bool pressed)
+{
+    // Queue an edge if the state of the output after all queued edges differs from the specified one.
+    if (output.getTarget() != pressed)
+        queueEdge(key, output);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::tapOutput(const Key &key, KeyOutput &output)
+{
+    // If the output is going to be released, queue a press and a release. Otherwise, the key char is already held
+    // down by another action and releasing it would end that action, so the tap is dropped.
+    if (output.getTarget())
+        return;
+
+    queueEdge(key, output);
+    queueEdge(key, output);
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::queueEdge(const Key &key, KeyOutput &output)
+{
+    // If the queue is full, the new edge is the opposite of the last queued one, so both cancel each other out. Dropping them
+    // loses a tap, but keeps the queue bounded and the edges in order, which matters more for rhythm games than a lost tap here.
+    if (output.queuedEdges == KEY_OUTPUT_QUEUE_SIZE)
+    {
+        output.queuedEdges--;
+        coalescedEdges += 2;
+        return;
+    }
+
+    // If there is an edge queued before the new one, the new one has to wait for at least one more report.
+    if (output.queuedEdges > 0)
+        delayedEdges++;
+
+    // Remember the time of the sample of the key that caused the edge and the time it was queued for the latency beacon.
+    uint8_t slot = (output.queueStart + output.queuedEdges) % KEY_OUTPUT_QUEUE_SIZE;
+    output.sampleTimes[slot] = key.sampleTime;
+    output.queueTimes[slot] = micros();
+    output.queuedEdges++;
+}
+
+template <typename TBoard>
+bool BasicKeyHandler<TBoard>::sendEdge(KeyOutput &output)
+{
+    // If there is no edge queued, there is nothing to send.
+    if (output.queuedEdges == 0)
+        return false;
+
+    // Apply the next edge to the HID report.
+    output.reported = !output.reported;
+    output.queuedEdges--;
+    if (output.reported)
+        Keyboard.press(output.keyChar);
+    else
+        Keyboard.release(output.keyChar);
+
+    // Add a record of the edge to the latency beacon, which is sent along with the report.
+    if (LatencyBeacon.enabled)
+        LatencyBeacon.add(output.keyChar, output.reported, output.sampleTimes[output.queueStart], output.queueTimes[output.queueStart]);
+    output.queueStart = (output.queueStart + 1) % KEY_OUTPUT_QUEUE_SIZE;
+
+    return true;
+}
+
+template <typename TBoard>
+uint16_t BasicKeyHandler<TBoard>::getBlockedSOCDPresses()
+{
+    // The Hall Effect keys whose queued press has to wait for a later report, as a bitmask.
+    uint16_t blocked = 0;
+
+    // Every key char has its own queue, so the edges of the keys of an SOCD group are not necessarily sent together. A press of a key
+    // in a group is therefore held back as long as another key of the group is still pressed after the next report, which is the case
+    // if it stays pressed without queued edges or if its press goes into the same report. Releases are never held back, so a winner
+    // switch lands in a single report if the losing key has no other edges queued, and otherwise one report later.
+    for (uint8_t i = 0; i < SOCD_GROUPS; i++)
+    {
+        const SOCDGroup &group = ConfigController.config.socdGroups[i];
+        if (group.mode == SOCDMode::Off)
+            continue;
+
+        // Collect the keys of the group that stay pressed after the next report, then let the queued presses through in order of
+        // the key indices as long as no other key of the group is pressed after the next report.
+        uint16_t pressedAfter = 0;
+        for (const HEKey &key : heKeys)
+            if ((group.keys & (1 << key.index)) && key.actuationPointCount == 0 && key.output.reported && key.output.queuedEdges == 0)
+                pressedAfter |= 1 << key.index;
+
+        for (const HEKey &key : heKeys)
+        {
+            if (!(group.keys & (1 << key.index)) || key.actuationPointCount > 0 || key.output.reported || key.output.queuedEdges == 0)
+                continue;
+
+            if (pressedAfter & ~(1 << key.index))
+                blocked |= 1 << key.index;
+            else
+                pressedAfter |= 1 << key.index;
+        }
+    }
+
+    return blocked;
+}
+
+template <typename TBoard>
+void BasicKeyHandler<TBoard>::sendReport()
+{
+    // If the last report has not been picked up by the host yet, sending a new one would overwrite it, dropping any edge in it that has
+    // not been sent yet. In that case, the edges stay queued until the next pass. Otherwise, apply at most one edge per key char to the
+    // report, so that rapid transitions (e.g. a press and release between two polls of the host) are spread over consecutive reports.
+    if (!tud_hid_ready())
+        return;
+
+    // Hold back the presses of keys in SOCD groups that would otherwise be in the report together with another key of their group.
+    uint16_t blocked = getBlockedSOCDPresses();
+    for (HEKey &key : heKeys)
+    {
+        if (!(blocked & (1 << key.index)))
+            reportChanged |= sendEdge(key.output);
+        reportChanged |= sendEdge(key.holdOutput);
+        for (uint8_t i = 0; i < key.actuationPointCount; i++)
+            reportChanged |= sendEdge(key.actuationOutputs[i]);
+    }
+
+    for (DigitalKey &key : digitalKeys)
+    {
+        reportChanged |= sendEdge(key.output);
+        reportChanged |= sendEdge(key.holdOutput);
+    }
+
+    // Only send the report if it changed, leaving the interface free for the other reports (e.g. the gamepad) otherwise.
+    // The records of the latency beacon are sent afterwards, so that they do not delay the report.
+    if (reportChanged)
+    {
+        // Measure the time spent handing the report to the USB stack for the deadline monitor.
+        uint32_t start = micros();
+        Keyboard.sendReport();
+        DeadlineMonitor.reportTime += micros() - start;
+        DeadlineMonitor.flag(DeadlineFlag::ReportSent);
+
+        LatencyBeacon.flush();
+    }
+
+    reportChanged = false;
+}
+
+// Explicitly instantiate the key handler for the board family the firmware is built for.
+template class BasicKeyHandler<Board>;
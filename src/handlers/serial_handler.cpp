@@ -2,7 +2,13 @@
 #include "handlers/keys/he_key.hpp"
 #include "handlers/serial_handler.hpp"
 #include "handlers/key_handler.hpp"
+#include "handlers/idle_handler.hpp"
+#include "handlers/gamepad_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/profiler.hpp"
+#include "helpers/logger.hpp"
+#include "helpers/latency_beacon.hpp"
+#include "helpers/deadline_monitor.hpp"
 #include "definitions.hpp"
 extern "C"
 {
@@ -49,10 +55,46 @@ void SerialHandler::handleSerialInput(char *input)
         name(parameters);
     else if (isEqual(command, "out"))
         out();
+    else if (isEqual(command, "idle"))
+        idle(atol(arg0));
+    else if (isEqual(command, "stats"))
+        stats(arg0);
+    else if (isEqual(command, "gp"))
+        gp(isTrue(arg0));
+    else if (isEqual(command, "gpcurve"))
+        gpcurve(atoi(arg0));
+    else if (isEqual(command, "gpdz"))
+        gpdz(atoi(arg0));
+    else if (isEqual(command, "chatter"))
+        chatter(atoi(arg0));
+    else if (isEqual(command, "checkpoint"))
+        checkpoint(atoi(arg0));
+    else if (isEqual(command, "noise"))
+        noise();
+    else if (isEqual(command, "tune"))
+        tune();
+    else if (isEqual(command, "socd"))
+        socd(parameters);
+    else if (isEqual(command, "log"))
+        log();
+    else if (isEqual(command, "xtalk"))
+        xtalk(arg0);
+    else if (isEqual(command, "latency"))
+        latency(isTrue(arg0));
+    else if (isEqual(command, "deadline"))
+        deadline(arg0);
+#ifdef USE_GAUSS_CORRECTION_LUT
+    else if (isEqual(command, "gcal"))
+        gcal(parameters);
+#endif
 #ifdef DEV
     else if (isEqual(command, "echo"))
         echo(parameters);
 #endif
+#if DEV
+    else if (isEqual(command, "prof"))
+        prof(arg0, parameters);
+#endif
 
     // Handle hall effect key specific commands by checking if the command starts with "hkey".
     if (strstr(command, "hkey") == command)
@@ -72,7 +114,7 @@ void SerialHandler::handleSerialInput(char *input)
         {
             // Get the index and check if it's in the valid range.
             uint8_t keyIndex = atoi(keyStr + 4) - 1;
-            if (keyIndex >= HE_KEYS)
+            if (keyIndex >= Board::heKeyCount)
                 return;
 
             // Replace the array with that single key.
@@ -80,7 +122,7 @@ void SerialHandler::handleSerialInput(char *input)
         }
 
         // Apply the command to all targetted hall effect keys.
-        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : HE_KEYS); i++)
+        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : Board::heKeyCount); i++)
         {
             // Get the key from the pointer array.
             HEKeyConfig &key = keys[i];
@@ -98,11 +140,34 @@ void SerialHandler::handleSerialInput(char *input)
                 hkey_lh(key, atoi(arg0));
             else if (isEqual(setting, "uh"))
                 hkey_uh(key, atoi(arg0));
+            else if (isEqual(setting, "drift"))
+                hkey_drift(key, isTrue(arg0));
+            else if (isEqual(setting, "os"))
+                hkey_os(key, atoi(arg0));
+            else if (isEqual(setting, "ap"))
+                hkey_ap(key, parameters);
+            else if (isEqual(setting, "holddist"))
+                hkey_holddist(key, atoi(arg0));
             else if (isEqual(setting, "char"))
                 key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
             else if (isEqual(setting, "hid"))
                 key_hid(key, isTrue(arg0));
+            else if (isEqual(setting, "mode"))
+                key_mode(key, atoi(arg0));
+            else if (isEqual(setting, "layer"))
+                key_layer(key, atoi(arg0));
+            else if (isEqual(setting, "hold"))
+                key_hold(key, parseKeyChar(arg0));
+            else if (isEqual(setting, "holdtime"))
+                key_holdtime(key, atoi(arg0));
+            else if (isEqual(setting, "lchar"))
+                key_lchar(key, parameters);
         }
+
+        // Update the precomputed actuation points of all Hall Effect keys, since the settings they are based on might have changed.
+        // Keys whose actuation points did not change are left untouched.
+        for (HEKey &key : KeyHandler.heKeys)
+            KeyHandler.updateActuationPoints(key);
     }
 
     // Handle digital key specific commands by checking if the command starts with "dkey".
@@ -124,7 +189,7 @@ void SerialHandler::handleSerialInput(char *input)
             // Get the index and check if it's in the valid range.
             uint8_t keyIndex = atoi(keyStr + 4) - 1;
 #pragma GCC diagnostic ignored "-Wtype-limits"
-            if (keyIndex >= DIGITAL_KEYS)
+            if (keyIndex >= Board::digitalKeyCount)
 #pragma GCC diagnostic pop
                 return;
 
@@ -133,7 +198,7 @@ void SerialHandler::handleSerialInput(char *input)
         }
 
         // Apply the command to all targetted digital keys.
-        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : DIGITAL_KEYS); i++)
+        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : Board::digitalKeyCount); i++)
         {
             // Get the key from the pointer array.
             DigitalKeyConfig &key = keys[i];
@@ -143,6 +208,16 @@ void SerialHandler::handleSerialInput(char *input)
                 key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
             else if (isEqual(setting, "hid"))
                 key_hid(key, isTrue(arg0));
+            else if (isEqual(setting, "mode"))
+                key_mode(key, atoi(arg0));
+            else if (isEqual(setting, "layer"))
+                key_layer(key, atoi(arg0));
+            else if (isEqual(setting, "hold"))
+                key_hold(key, parseKeyChar(arg0));
+            else if (isEqual(setting, "holdtime"))
+                key_holdtime(key, atoi(arg0));
+            else if (isEqual(setting, "lchar"))
+                key_lchar(key, parameters);
         }
     }
 }
@@ -163,13 +238,35 @@ void SerialHandler::get()
 {
     // Output all global settings.
     print("GET version=%s%s", FIRMWARE_VERSION, DEV ? "-dev" : "");
-    print("GET hkeys=%d", HE_KEYS);
-    print("GET dkeys=%d", DIGITAL_KEYS);
+    print("GET board=%s", KeyHandler.board->name);
+    print("GET hkeys=%d", Board::heKeyCount);
+    print("GET dkeys=%d", Board::digitalKeyCount);
     print("GET name=%s", ConfigController.config.name);
+    print("GET idle=%lu", ConfigController.config.idleTimeout);
+    print("GET gp=%d", ConfigController.config.gamepadOutput);
+    print("GET gpcurve=%d", ConfigController.config.gamepadCurve);
+    print("GET gpdz=%d", ConfigController.config.gamepadDeadzone);
+    print("GET chatter=%d", ConfigController.config.chatterThreshold);
+    print("GET checkpoint=%d", ConfigController.config.statisticsCheckpointInterval);
+    print("GET deadline=%d", ConfigController.config.loopDeadline);
     print("GET htol=%d", HYSTERESIS_TOLERANCE);
     print("GET rtol=%d", RAPID_TRIGGER_TOLERANCE);
     print("GET trdt=%d", TRAVEL_DISTANCE_IN_0_01MM);
     print("GET ares=%d", ANALOG_RESOLUTION);
+    print("GET sres=%d", SENSOR_RESOLUTION);
+    print("GET layers=%d", LAYERS);
+    print("GET layer=%d", KeyHandler.activeLayer);
+
+    // Output the mode and the one-based indices of the Hall Effect keys of every SOCD group.
+    for (uint8_t i = 0; i < SOCD_GROUPS; i++)
+    {
+        const SOCDGroup &group = ConfigController.config.socdGroups[i];
+        char keys[Board::heKeyCount * 3 + 1] = {0};
+        for (uint8_t j = 0; j < Board::heKeyCount; j++)
+            if (group.keys & (1 << j))
+                sprintf(keys + strlen(keys), " %d", j + 1);
+        print("GET socd%d=%d%s", i + 1, (int)group.mode, keys);
+    }
 
     // Output all hall effect key-specific settings.
     for (const HEKey &key : KeyHandler.heKeys)
@@ -181,10 +278,34 @@ void SerialHandler::get()
         print("GET hkey%d.rtds=%d", key.index + 1, key.config->rapidTriggerDownSensitivity);
         print("GET hkey%d.lh=%d", key.index + 1, key.config->lowerHysteresis);
         print("GET hkey%d.uh=%d", key.index + 1, key.config->upperHysteresis);
+        print("GET hkey%d.dz=%d", key.index + 1, key.config->sensorBoundaryDeadzone);
+        print("GET hkey%d.sma=%d", key.index + 1, key.config->smaFilterSampleExponent);
+        print("GET hkey%d.os=%d", key.index + 1, key.config->oversamplingExponent);
+        print("GET hkey%d.rtol=%d", key.index + 1, key.config->rapidTriggerTolerance);
+        print("GET hkey%d.drift=%d", key.index + 1, key.config->driftTracking);
+        for (uint8_t i = 0; i < ACTUATION_POINTS; i++)
+        {
+            const ActuationPoint &point = key.config->actuationPoints[i];
+            print("GET hkey%d.ap%d=%d %d %d %d", key.index + 1, i + 1, point.distance, point.keyChar, (int)point.pressAction, (int)point.releaseAction);
+        }
         print("GET hkey%d.char=%d", key.index + 1, key.config->keyChar);
         print("GET hkey%d.hid=%d", key.index + 1, key.config->hidEnabled);
+        printKeyMode("hkey", key);
+        print("GET hkey%d.holddist=%d", key.index + 1, key.config->holdDistance);
         print("GET hkey%d.rest=%d", key.index + 1, key.restPosition);
         print("GET hkey%d.down=%d", key.index + 1, key.downPosition);
+        print("GET hkey%d.recal=%lu", key.index + 1, key.recalibrations);
+        print("GET hkey%d.outliers=%lu", key.index + 1, (unsigned long)(key.restTracker.rejected + key.downTracker.rejected));
+
+        // Output the row of the key in the crosstalk matrix, being the shift per deflection of every other key in Q15 fixed-point.
+        char crosstalk[Board::heKeyCount * 7 + 1] = {0};
+        for (uint8_t i = 0; i < Board::heKeyCount; i++)
+            sprintf(crosstalk + strlen(crosstalk), " %d", ConfigController.config.crosstalk[key.index][i]);
+        print("GET hkey%d.xtalk=%s", key.index + 1, crosstalk + 1);
+#ifdef USE_GAUSS_CORRECTION_LUT
+        GaussParameters gauss = KeyHandler.getGaussParameters(key);
+        print("GET hkey%d.gauss=%d %.8g %.8g %.8g %.8g", key.index + 1, key.config->customGauss, gauss.a, gauss.b, gauss.c, gauss.d);
+#endif
     }
 
     // Output all digital key-specific settings.
@@ -192,12 +313,27 @@ void SerialHandler::get()
     {
         print("GET dkey%d.char=%d", key.index + 1, key.config->keyChar);
         print("GET dkey%d.hid=%d", key.index + 1, key.config->hidEnabled);
+        printKeyMode("dkey", key);
     }
 
     // Print this line to signalize the end of printing the settings to the listener.
     Serial.println("GET END");
 }
 
+void SerialHandler::printKeyMode(const char *identifier, const Key &key)
+{
+    // Output the mode settings shared by all keys, with the key chars of the layers above the base layer in one line.
+    print("GET %s%d.mode=%d", identifier, key.index + 1, (int)key.config->mode);
+    print("GET %s%d.layer=%d", identifier, key.index + 1, key.config->layer);
+    print("GET %s%d.hold=%d", identifier, key.index + 1, key.config->holdKeyChar);
+    print("GET %s%d.holdtime=%d", identifier, key.index + 1, key.config->holdTime);
+
+    char layerKeyChars[(LAYERS - 1) * 4 + 1] = {0};
+    for (uint8_t i = 0; i < LAYERS - 1; i++)
+        sprintf(layerKeyChars + strlen(layerKeyChars), " %d", (uint8_t)key.config->layerKeyChars[i]);
+    print("GET %s%d.lchar=%s", identifier, key.index + 1, layerKeyChars + 1);
+}
+
 void SerialHandler::name(char *name)
 {
     // Get the length of the name and check if it's within the 1-128 characters boundary.
@@ -213,6 +349,324 @@ void SerialHandler::out()
         print("OUT hkey%d=%d %d", key.index + 1, key.rawValue, key.distance);
 }
 
+void SerialHandler::idle(uint32_t timeout)
+{
+    // Set the idle timeout config value to the specified value. 0 disables the idle mode.
+    ConfigController.config.idleTimeout = timeout;
+}
+
+void SerialHandler::gp(bool state)
+{
+    // Set the gamepad output config value to the specified state.
+    ConfigController.config.gamepadOutput = state;
+}
+
+void SerialHandler::gpcurve(uint16_t value)
+{
+    // Check if the specified value is within the GAMEPAD_MIN_CURVE-GAMEPAD_MAX_CURVE boundary.
+    if (value < GAMEPAD_MIN_CURVE || value > GAMEPAD_MAX_CURVE)
+        return;
+
+    // Set the gamepad curve config value to the specified value and recalculate the response curve.
+    ConfigController.config.gamepadCurve = value;
+    GamepadHandler.updateResponseCurve();
+}
+
+void SerialHandler::gpdz(uint16_t value)
+{
+    // Check if the specified value leaves at least some travel distance for the axes.
+    if (value >= TRAVEL_DISTANCE_IN_0_01MM)
+        return;
+
+    // Set the gamepad deadzone config value to the specified value and recalculate the response curve.
+    ConfigController.config.gamepadDeadzone = value;
+    GamepadHandler.updateResponseCurve();
+}
+
+void SerialHandler::chatter(uint16_t threshold)
+{
+    // Set the chatter threshold config value to the specified value.
+    ConfigController.config.chatterThreshold = threshold;
+}
+
+void SerialHandler::checkpoint(uint16_t interval)
+{
+    // Check if the specified value is either 0 (disabled) or at least the minimum interval, to not wear out the flash.
+    if (interval == 0 || interval >= STATISTICS_MIN_CHECKPOINT_INTERVAL)
+        // Set the statistics checkpoint interval config value to the specified value.
+        ConfigController.config.statisticsCheckpointInterval = interval;
+}
+
+void SerialHandler::printKeyStatistics(const char *identifier, const Key &key)
+{
+    // Output the counters of the key and the histogram of its press durations.
+    const KeyStatistics &statistics = *key.statistics;
+    print("STATS %s%d.presses=%lu", identifier, key.index + 1, statistics.presses);
+    print("STATS %s%d.releases=%lu", identifier, key.index + 1, statistics.releases);
+    print("STATS %s%d.rt=%lu", identifier, key.index + 1, statistics.rapidTriggers);
+    print("STATS %s%d.crtresets=%lu", identifier, key.index + 1, statistics.continuousRapidTriggerResets);
+    print("STATS %s%d.chatter=%lu", identifier, key.index + 1, statistics.chatters);
+
+    char durations[KEY_STATISTICS_DURATION_BUCKETS * 11 + 1] = {0};
+    for (uint32_t count : statistics.durations)
+        sprintf(durations + strlen(durations), " %lu", (unsigned long)count);
+    print("STATS %s%d.durations=%s", identifier, key.index + 1, durations + 1);
+}
+
+void SerialHandler::stats(char *action)
+{
+    // If "reset" is specified, reset the statistics of the keys instead of outputting the statistics.
+    if (isEqual(action, "reset"))
+    {
+        StatisticsController.resetStatistics();
+        return;
+    }
+
+    // Output the statistics of all Hall Effect and digital keys.
+    for (const HEKey &key : KeyHandler.heKeys)
+        printKeyStatistics("hkey", key);
+    for (const DigitalKey &key : KeyHandler.digitalKeys)
+        printKeyStatistics("dkey", key);
+
+    // Output the amount of edges that have been delayed or coalesced by the queues of the HID report.
+    print("STATS delayededges=%lu", KeyHandler.delayedEdges);
+    print("STATS coalescededges=%lu", KeyHandler.coalescedEdges);
+
+    // Output the statistics of the idle mode.
+    print("STATS idle=%d", IdleHandler.idle);
+    print("STATS idletime=%lu", IdleHandler.getIdleTime());
+    print("STATS wakes=%lu", IdleHandler.wakes);
+    print("STATS maxwakelatency=%lu", IdleHandler.maxWakeLatency);
+
+    // Print this line to signalize the end of printing the statistics to the listener.
+    Serial.println("STATS END");
+}
+
+void SerialHandler::noise()
+{
+    // Output the mean, standard deviation and peak-to-peak range of the unfiltered and filtered sensor readings at rest of every
+    // Hall Effect key. The standard deviation is converted from Q8 fixed-point into a decimal number with 2 decimal places.
+    for (const HEKey &key : KeyHandler.heKeys)
+    {
+        const NoiseStats &raw = key.rawNoise;
+        const NoiseStats &filtered = key.filteredNoise;
+        print("NOISE hkey%d.raw=%d %lu.%02lu %d", key.index + 1, raw.mean, raw.standardDeviation >> 8,
+              ((raw.standardDeviation & 0xFF) * 100) >> 8, raw.peakToPeak);
+        print("NOISE hkey%d.filtered=%d %lu.%02lu %d", key.index + 1, filtered.mean, filtered.standardDeviation >> 8,
+              ((filtered.standardDeviation & 0xFF) * 100) >> 8, filtered.peakToPeak);
+    }
+}
+
+void SerialHandler::tune()
+{
+    // Auto-tune the deadzone, filter depth and rapid trigger tolerance of every Hall Effect key based on its noise statistics.
+    // Keys that have not been calibrated or measured at rest yet are skipped and keep their current configuration.
+    for (HEKey &key : KeyHandler.heKeys)
+    {
+        if (KeyHandler.autoTune(key))
+            print("TUNE hkey%d=%d %d %d", key.index + 1, key.config->sensorBoundaryDeadzone,
+                  key.config->smaFilterSampleExponent, key.config->rapidTriggerTolerance);
+        else
+            print("TUNE hkey%d=skipped", key.index + 1);
+    }
+
+    // Update the precomputed actuation points since they depend on the rapid trigger tolerance, and persist the tuned values.
+    // Keys whose tolerance did not change keep their actuation points as they are.
+    for (HEKey &key : KeyHandler.heKeys)
+        KeyHandler.updateActuationPoints(key);
+    ConfigController.saveConfig();
+}
+
+void SerialHandler::socd(char *parameters)
+{
+    // Parse the one-based index of the SOCD group and its mode.
+    char *end;
+    unsigned long index = strtoul(parameters, &end, 10);
+    unsigned long mode = strtoul(end, &end, 10);
+
+    // Check if the index is valid and the mode exists.
+    if (index < 1 || index > SOCD_GROUPS || mode > (uint8_t)SOCDMode::DeepestTravel)
+        return;
+
+    // Parse the one-based indices of the Hall Effect keys in the group until the end of the parameters is reached.
+    // If any of the indices is not a valid key, the command is ignored.
+    uint16_t keys = 0;
+    while (*end != '\0')
+    {
+        char *start = end;
+        unsigned long key = strtoul(start, &end, 10);
+        if (end == start || key < 1 || key > Board::heKeyCount)
+            return;
+
+        keys |= 1 << (key - 1);
+    }
+
+    // Set the SOCD group config values to the specified ones. Mode 0 disables the group.
+    SOCDGroup &group = ConfigController.config.socdGroups[index - 1];
+    group.mode = (SOCDMode)mode;
+    group.keys = keys;
+}
+
+#ifdef USE_GAUSS_CORRECTION_LUT
+void SerialHandler::gcal(char *parameters)
+{
+    // Parse the one-based index of the Hall Effect key and whether to start or reset the gauss calibration of it.
+    char *end;
+    unsigned long index = strtoul(parameters, &end, 10);
+    char *second = end;
+    unsigned long start = strtoul(second, &end, 10);
+    bool reset = end != second && start == 0;
+
+    // If no key is specified, output the state of the current gauss calibration, including the fitted curve once it is done.
+    if (second == parameters)
+    {
+        const GaussFitter &fitter = KeyHandler.gaussFitter;
+        const GaussParameters &gauss = fitter.parameters;
+        print("GCAL hkey%d=%d %d", fitter.keyIndex + 1, (int)fitter.state, fitter.progress);
+        if (fitter.state == GaussCalibrationState::Done)
+            print("GCAL hkey%d.gauss=%.8g %.8g %.8g %.8g", fitter.keyIndex + 1, gauss.a, gauss.b, gauss.c, gauss.d);
+        return;
+    }
+
+    // Check if the index is valid.
+    if (index < 1 || index > Board::heKeyCount)
+        return;
+
+    // Start the gauss calibration on the key unless the second parameter is 0, which returns the key to the curve of the board instead.
+    HEKey &key = KeyHandler.heKeys[index - 1];
+    if (reset)
+        KeyHandler.resetGaussCalibration(key);
+    else if (!KeyHandler.startGaussCalibration(key))
+        print("GCAL hkey%d=uncalibrated", key.index + 1);
+}
+#endif
+
+void SerialHandler::xtalk(char *action)
+{
+    // Start the crosstalk calibration, which requires all keys to be calibrated and resting.
+    if (isEqual(action, "start"))
+    {
+        if (!KeyHandler.startCrosstalkCalibration())
+            Serial.println("XTALK uncalibrated");
+    }
+
+    // Clear the crosstalk matrix, disabling the compensation.
+    else if (isEqual(action, "reset"))
+        KeyHandler.resetCrosstalkCalibration();
+
+    // Otherwise, output the state of the current crosstalk calibration and whether each key has been pressed down fully on its own yet.
+    else
+    {
+        const CrosstalkCalibrator &calibrator = KeyHandler.crosstalkCalibrator;
+        print("XTALK state=%d", (int)calibrator.state);
+        for (uint8_t i = 0; i < Board::heKeyCount; i++)
+            print("XTALK hkey%d=%d", i + 1, (calibrator.completedKeys >> i) & 1);
+    }
+}
+
+void SerialHandler::latency(bool state)
+{
+    // Enable or disable the records of the latency beacon. This is not saved, since the records are only meant for measurements.
+    LatencyBeacon.enabled = state;
+}
+
+void SerialHandler::deadline(char *action)
+{
+    // If "reset" is specified, clear the overrun counters and snapshots of the deadline monitor.
+    if (isEqual(action, "reset"))
+    {
+        DeadlineMonitor.reset();
+        return;
+    }
+
+    // If a value is specified, set the loop deadline config value to it. 0 disables the capture of overruns.
+    if (strlen(action) > 0)
+    {
+        ConfigController.config.loopDeadline = atoi(action);
+        return;
+    }
+
+    // Output the counters of the deadline monitor.
+    print("DEADLINE deadline=%d", ConfigController.config.loopDeadline);
+    print("DEADLINE iterations=%lu", (unsigned long)DeadlineMonitor.iterations);
+    print("DEADLINE overruns=%lu", (unsigned long)DeadlineMonitor.overruns);
+    print("DEADLINE max=%lu", (unsigned long)DeadlineMonitor.maxDuration);
+
+    // Output the snapshots of the worst overruns in the format <timestamp> <duration> <keys> <gamepad> <idle> <statistics> <core> <serial>
+    // <report> <flags> <frame>, with the time spent in every stage and handing reports to the USB stack in microseconds.
+    for (uint8_t i = 0; i < DeadlineMonitor.snapshotCount; i++)
+    {
+        const DeadlineSnapshot &snapshot = DeadlineMonitor.snapshots[i];
+        char stages[LOOP_STAGES * 11 + 1] = {0};
+        for (uint32_t time : snapshot.stageTimes)
+            sprintf(stages + strlen(stages), " %lu", (unsigned long)time);
+        print("DEADLINE snapshot%d=%lu %lu%s %lu %d %d", i + 1, (unsigned long)snapshot.timestamp, (unsigned long)snapshot.duration, stages,
+              (unsigned long)snapshot.reportTime, snapshot.flags, snapshot.frame);
+    }
+
+    // Print this line to signalize the end of the deadline monitor output to the listener.
+    Serial.println("DEADLINE END");
+}
+
+void SerialHandler::log()
+{
+    // Output the amount of records dropped since boot, so the listener can tell whether the log is complete.
+    print("LOG dropped=%lu", (unsigned long)Logger.dropped.load());
+
+    // Drain the ring buffer of the logger as binary blocks, each announced with its size in bytes and followed by a newline character.
+    // Since the ring buffer may wrap around, this takes up to two blocks. The records are decoded on the host via log-util.py.
+    uint32_t count;
+    const uint32_t *words;
+    while ((words = Logger.peek(count), count > 0))
+    {
+        print("LOG size=%lu", (unsigned long)(count * sizeof(uint32_t)));
+        Serial.write(reinterpret_cast<const uint8_t *>(words), count * sizeof(uint32_t));
+        Serial.println();
+        Logger.consume(count);
+    }
+
+    // Print this line to signalize the end of the log to the listener.
+    Serial.println("LOG END");
+}
+
+#if DEV
+void SerialHandler::prof(char *action, char *parameters)
+{
+    // Start the profiler with the specified interval in microseconds or the default one, if none is specified.
+    if (isEqual(action, "start"))
+    {
+        char interval[SERIAL_INPUT_BUFFER_SIZE];
+        StringHelper::getArgumentAt(parameters, ' ', 1, interval);
+        Profiler.start(strlen(interval) > 0 ? atol(interval) : PROFILER_INTERVAL_US);
+    }
+
+    // Stop the profiler, keeping the histogram.
+    else if (isEqual(action, "stop"))
+        Profiler.stop();
+
+    // Clear the histogram.
+    else if (isEqual(action, "reset"))
+        Profiler.reset();
+
+    // Otherwise, output the histogram, one line per bucket with the address of the first instruction covered by it.
+    // This output is meant to be symbolized on the host via profiler-util.py.
+    else
+    {
+        print("PROF running=%d", Profiler.running);
+        print("PROF interval=%lu", Profiler.interval);
+        print("PROF samples=%lu", Profiler.samples);
+        print("PROF dropped=%lu", Profiler.dropped);
+        print("PROF bucketsize=%d", PROFILER_BUCKET_SIZE);
+        for (const ProfilerBucket &bucket : Profiler.buckets)
+            if (bucket.address != 0)
+                print("PROF 0x%08lx=%lu", bucket.address, bucket.count);
+
+        // Print this line to signalize the end of printing the histogram to the listener.
+        Serial.println("PROF END");
+    }
+}
+#endif
+
 void SerialHandler::echo(char *input)
 {
     // Output the same input. This command is used for debugging purposes and only available in said environemnts.
@@ -234,7 +688,7 @@ void SerialHandler::hkey_crt(HEKeyConfig &config, bool state)
 void SerialHandler::hkey_rtus(HEKeyConfig &config, uint16_t value)
 {
     // Check if the specified value is within the tolerance-TRAVEL_DISTANCE_IN_0_01MM boundary.
-    if (value >= RAPID_TRIGGER_TOLERANCE && value <= TRAVEL_DISTANCE_IN_0_01MM)
+    if (value >= config.rapidTriggerTolerance && value <= TRAVEL_DISTANCE_IN_0_01MM)
         // Set the rapid trigger up sensitivity config value to the specified state.
         config.rapidTriggerUpSensitivity = value;
 }
@@ -242,7 +696,7 @@ void SerialHandler::hkey_rtus(HEKeyConfig &config, uint16_t value)
 void SerialHandler::hkey_rtds(HEKeyConfig &config, uint16_t value)
 {
     // Check if the specified value is within the tolerance-TRAVEL_DISTANCE_IN_0_01MM boundary.
-    if (value >= RAPID_TRIGGER_TOLERANCE && value <= TRAVEL_DISTANCE_IN_0_01MM)
+    if (value >= config.rapidTriggerTolerance && value <= TRAVEL_DISTANCE_IN_0_01MM)
         // Set the rapid trigger down sensitivity config value to the specified state.
         config.rapidTriggerDownSensitivity = value;
 }
@@ -265,6 +719,59 @@ void SerialHandler::hkey_uh(HEKeyConfig &config, uint16_t value)
         config.upperHysteresis = value;
 }
 
+void SerialHandler::hkey_drift(HEKeyConfig &config, bool state)
+{
+    // Set the drift tracking config value to the specified state.
+    config.driftTracking = state;
+}
+
+void SerialHandler::hkey_os(HEKeyConfig &config, uint8_t value)
+{
+    // Check if the specified value is within the 0-OVERSAMPLING_MAX_EXPONENT boundary.
+    if (value <= OVERSAMPLING_MAX_EXPONENT)
+        // Set the oversampling exponent config value to the specified state.
+        config.oversamplingExponent = value;
+}
+
+void SerialHandler::hkey_ap(HEKeyConfig &config, char *parameters)
+{
+    // Parse the one-based index of the actuation point, its distance, key char and the actions performed when crossing it downwards and upwards.
+    // The key char may be specified either as the ASCII character or integer, just like with the char command.
+    unsigned int index, distance, pressAction, releaseAction;
+    char keyChar[4];
+    if (sscanf(parameters, "%u %u %3s %u %u", &index, &distance, keyChar, &pressAction, &releaseAction) != 5)
+        return;
+
+    // Check if the index is valid, the distance leaves room for the release distance (the distance plus the rapid trigger tolerance)
+    // within the travel distance and the actions exist.
+    if (index < 1 || index > ACTUATION_POINTS || distance + config.rapidTriggerTolerance > TRAVEL_DISTANCE_IN_0_01MM ||
+        pressAction > (uint8_t)ActuationAction::Tap || releaseAction > (uint8_t)ActuationAction::Tap)
+        return;
+
+    // Set the actuation point config values to the specified ones. A key char of 0 disables the actuation point.
+    ActuationPoint &point = config.actuationPoints[index - 1];
+    point.distance = distance;
+    point.keyChar = parseKeyChar(keyChar);
+    point.pressAction = (ActuationAction)pressAction;
+    point.releaseAction = (ActuationAction)releaseAction;
+}
+
+uint8_t SerialHandler::parseKeyChar(const char *input)
+{
+    // Parse the key char either as the ASCII character or integer, just like with the char command. A literal 0 is parsed as the integer,
+    // since it is used to disable a key char (e.g. of an actuation point) and the character '0' is still available as its integer 48.
+    return strlen(input) == 1 && input[0] != '0' ? input[0] : atoi(input);
+}
+
+void SerialHandler::hkey_holddist(HEKeyConfig &config, uint16_t value)
+{
+    // Make sure the hold distance is within the travel distance. 0 disables the hold distance.
+    if (value > TRAVEL_DISTANCE_IN_0_01MM)
+        return;
+
+    config.holdDistance = value;
+}
+
 void SerialHandler::key_char(KeyConfig &config, uint8_t keyChar)
 {
     // Set the key config value of the specified key to the specified state.
@@ -276,3 +783,44 @@ void SerialHandler::key_hid(KeyConfig &config, bool state)
     // Set the hid config value of the specified key to the specified state.
     config.hidEnabled = state;
 }
+
+void SerialHandler::key_mode(KeyConfig &config, uint8_t mode)
+{
+    // Check if the mode exists.
+    if (mode > (uint8_t)KeyMode::ToggleLayer)
+        return;
+
+    config.mode = (KeyMode)mode;
+}
+
+void SerialHandler::key_layer(KeyConfig &config, uint8_t layer)
+{
+    // Make sure the layer is one of the layers above the base layer, since the base layer is always active.
+    if (layer < 1 || layer >= LAYERS)
+        return;
+
+    config.layer = layer;
+}
+
+void SerialHandler::key_hold(KeyConfig &config, uint8_t keyChar)
+{
+    // Set the hold key char of the specified key. A key char of 0 makes the key hold its layer instead.
+    config.holdKeyChar = keyChar;
+}
+
+void SerialHandler::key_holdtime(KeyConfig &config, uint16_t value)
+{
+    // Set the hold time of the specified key in milliseconds.
+    config.holdTime = value;
+}
+
+void SerialHandler::key_lchar(KeyConfig &config, char *parameters)
+{
+    // Parse the layer and the key char of the key on it. A key char of 0 makes the key fall through to the key char of the next lower layer.
+    unsigned int layer;
+    char keyChar[4];
+    if (sscanf(parameters, "%u %3s", &layer, keyChar) != 2 || layer < 1 || layer >= LAYERS)
+        return;
+
+    config.layerKeyChars[layer - 1] = parseKeyChar(keyChar);
+}
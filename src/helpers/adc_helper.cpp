@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include "helpers/adc_helper.hpp"
+#include "definitions.hpp"
+
+extern "C"
+{
+#include "hardware/adc.h"
+}
+
+// Sets up the ADC for bursts via its FIFO. This resets the ADC, so it is only done once before setting up the pins.
+void ADCHelper::begin()
+{
+    // Initialize the ADC and enable the FIFO, without DMA requests or error flags, so that the conversions
+    // of a burst can be read straight from the FIFO while the ADC is running at its full sample rate.
+    adc_init();
+    adc_fifo_setup(true, false, 1, false, false);
+}
+
+// Sets up the specified pin as an ADC input.
+void ADCHelper::beginPin(uint8_t pin)
+{
+    // Disable the digital functions of the pin so it can be used as an analog input.
+    adc_gpio_init(pin);
+}
+
+// Reads a burst of 2^exponent samples from the specified pin and decimates them into a single value with SENSOR_RESOLUTION bits.
+uint16_t ADCHelper::readOversampled(uint8_t pin, uint8_t exponent)
+{
+    // Select the ADC channel of the pin and let the ADC run freely, collecting the conversions from the FIFO as they come in.
+    // This takes one conversion time per sample (2µs), compared to the overhead of starting every conversion on its own.
+    adc_select_input(pin - A0);
+    adc_run(true);
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < (1 << exponent); i++)
+        sum += adc_fifo_get_blocking();
+
+    // Stop the ADC and discard the conversion that might have been started in the meantime, so that it does not end up in the next burst.
+    // Stopping the ADC does not abort a running conversion, so wait for it to finish first, otherwise its result from this channel would
+    // land in the FIFO after draining it and be read as the first sample of the next burst.
+    adc_run(false);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS))
+        tight_loop_contents();
+    adc_fifo_drain();
+
+    // Decimate the sum into SENSOR_RESOLUTION bits. Summing up 4^n samples with uncorrelated noise gains n bits of resolution, so
+    // a burst of 4 samples yields 13 bits and a burst of 16 samples yields 14 bits. Shorter bursts are scaled up to the same range.
+    return (sum << (SENSOR_RESOLUTION - ANALOG_RESOLUTION)) >> exponent;
+}
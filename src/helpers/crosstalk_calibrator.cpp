@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include "helpers/crosstalk_calibrator.hpp"
+#include "definitions.hpp"
+
+static_assert(Board::heKeyCount <= CROSSTALK_MAX_KEYS, "The crosstalk compensation only supports up to 16 hall effect keys.");
+
+/*
+   Explanation of the Crosstalk Compensation
+
+   The Hall Effect sensors sit close to each other, so the magnet of a pressed key also shifts the readings of its resting neighbours.
+   Without compensation, this shift is folded into the sensor boundaries of the resting keys and can move them across their hysteresis
+   or rapid trigger sensitivities, causing phantom presses or releases when only a neighbouring key is pressed.
+
+   The shift of a key is modelled as linear in the deflection of every other key, which is how far its reading dropped from its reading
+   at rest. The coefficients form the crosstalk matrix, with the shift of key i per deflection of key j in row i and column j, and are
+   measured by pressing one key at a time while the others rest. For every key j, the coefficients of its column are the least squares
+   fits of the shifts of the other keys over its deflection. On every scan, the coupling of all other keys is added back onto the reading.
+*/
+
+void CrosstalkCalibrator::begin(const uint16_t *values)
+{
+    for (uint8_t i = 0; i < Board::heKeyCount; i++)
+    {
+        baselines[i] = values[i];
+        variances[i] = 0;
+        for (uint8_t j = 0; j < Board::heKeyCount; j++)
+            covariances[i][j] = 0;
+    }
+
+    startTime = millis();
+    completedKeys = 0;
+    bottomedOutKeys = 0;
+    state = CrosstalkCalibrationState::Recording;
+}
+
+void CrosstalkCalibrator::update(const uint16_t *values, const uint16_t *distances)
+{
+    // Abort the calibration if not every key has been pressed in time.
+    if (millis() - startTime > CROSSTALK_CALIBRATION_TIMEOUT)
+    {
+        state = CrosstalkCalibrationState::Failed;
+        return;
+    }
+
+    // Keys that returned to rest after being pressed down fully are done.
+    for (uint8_t i = 0; i < Board::heKeyCount; i++)
+    {
+        if (distances[i] >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD)
+        {
+            if (bottomedOutKeys & (1 << i))
+                completedKeys |= 1 << i;
+
+            bottomedOutKeys &= ~(1 << i);
+        }
+        else if (distances[i] <= DRIFT_TRACKING_DOWN_THRESHOLD)
+            bottomedOutKeys |= 1 << i;
+    }
+
+    // Find the key driving the crosstalk, which is the one deflected the furthest. The sample is only recorded if that key is clearly pressed
+    // and no other key is, since the shift of a key could otherwise not be attributed to a single other key. The other keys are not required
+    // to read as resting, since the crosstalk itself shifts their distances, most of all for the strongest couplings.
+    uint8_t pressedKey = 0;
+    uint8_t pressedKeys = 0;
+    for (uint8_t i = 0; i < Board::heKeyCount; i++)
+    {
+        if ((int32_t)(baselines[i] - values[i]) > (int32_t)(baselines[pressedKey] - values[pressedKey]))
+            pressedKey = i;
+        if (distances[i] <= CROSSTALK_PRESSED_DISTANCE)
+            pressedKeys++;
+    }
+
+    // Accumulate the products of the deflection of the pressed key with the shifts of the other keys.
+    if (pressedKeys == 1 && distances[pressedKey] <= CROSSTALK_PRESSED_DISTANCE)
+    {
+        int32_t deflection = baselines[pressedKey] - values[pressedKey];
+        variances[pressedKey] += deflection * deflection;
+        for (uint8_t i = 0; i < Board::heKeyCount; i++)
+            if (i != pressedKey)
+                covariances[i][pressedKey] += deflection * (int32_t)(baselines[i] - values[i]);
+    }
+
+    // If not every key has been pressed down fully yet, the calibration is still in progress.
+    if (completedKeys != (1 << Board::heKeyCount) - 1)
+        return;
+
+    // Fit the coefficients in Q15 fixed-point and bound them. (see CROSSTALK_MAX_COEFFICIENT)
+    for (uint8_t i = 0; i < Board::heKeyCount; i++)
+        for (uint8_t j = 0; j < Board::heKeyCount; j++)
+        {
+            int64_t coefficient = i == j || variances[j] == 0 ? 0 : covariances[i][j] * 32768 / variances[j];
+            coefficients[i][j] = constrain(coefficient, -CROSSTALK_MAX_COEFFICIENT, CROSSTALK_MAX_COEFFICIENT);
+        }
+
+    state = CrosstalkCalibrationState::Done;
+}
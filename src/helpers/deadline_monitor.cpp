@@ -0,0 +1,99 @@
+#include <Arduino.h>
+#include <tusb.h>
+#include "helpers/deadline_monitor.hpp"
+#include "helpers/logger.hpp"
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "hardware/structs/usb.h"
+}
+
+void DeadlineMonitor::beginIteration()
+{
+    uint32_t now = micros();
+
+    // Finish the previous iteration, if there is one. The time since the last mark was spent outside of the firmware, in the core.
+    if (started)
+    {
+        stageTimes[(uint8_t)LoopStage::Core] += now - lastMark;
+
+        // Measure the iteration without the time that is not counted towards it (e.g. the sleep while idle) and check it against the deadline.
+        uint32_t duration = now - iterationStart - excludedTime;
+        iterations++;
+        maxDuration = max(maxDuration, duration);
+
+        uint16_t deadline = ConfigController.config.loopDeadline;
+        if (deadline != 0 && duration > deadline)
+        {
+            overruns++;
+            LOG_WARN("loop overrun of %luus", (unsigned long)duration);
+            capture(duration);
+        }
+    }
+
+    // Start the new iteration.
+    iterationStart = now;
+    lastMark = now;
+    iterationTimestamp = millis();
+    for (uint32_t &time : stageTimes)
+        time = 0;
+    excludedTime = 0;
+    reportTime = 0;
+    flags = 0;
+    started = true;
+}
+
+void DeadlineMonitor::mark(LoopStage stage, bool excluded)
+{
+    // Add the time since the last mark to the specified stage, and to the excluded time if it is not counted towards the iteration.
+    uint32_t now = micros();
+    stageTimes[(uint8_t)stage] += now - lastMark;
+    if (excluded)
+        excludedTime += now - lastMark;
+    lastMark = now;
+}
+
+void DeadlineMonitor::reset()
+{
+    // Clear the counters and snapshots. The current iteration is still measured, so the reset itself shows up as an overrun if it is slow.
+    iterations = 0;
+    overruns = 0;
+    maxDuration = 0;
+    snapshotCount = 0;
+}
+
+void DeadlineMonitor::capture(uint32_t duration)
+{
+    // Pick the slot of the snapshot. While there is space left, a new one is used. Otherwise, the shortest snapshot is replaced
+    // if the new overrun took longer, so that the worst overruns are kept.
+    uint8_t slot = snapshotCount;
+    if (snapshotCount == DEADLINE_SNAPSHOTS)
+    {
+        slot = 0;
+        for (uint8_t i = 1; i < DEADLINE_SNAPSHOTS; i++)
+            if (snapshots[i].duration < snapshots[slot].duration)
+                slot = i;
+
+        if (snapshots[slot].duration >= duration)
+            return;
+    }
+    else
+        snapshotCount++;
+
+    // Add the state of the USB device to the context of the iteration.
+    uint8_t context = flags;
+    if (tud_mounted())
+        context |= (uint8_t)DeadlineFlag::UsbMounted;
+    if (tud_suspended())
+        context |= (uint8_t)DeadlineFlag::UsbSuspended;
+
+    DeadlineSnapshot &snapshot = snapshots[slot];
+    snapshot.timestamp = iterationTimestamp;
+    snapshot.duration = duration;
+    for (uint8_t i = 0; i < LOOP_STAGES; i++)
+        snapshot.stageTimes[i] = stageTimes[i];
+    snapshot.reportTime = reportTime;
+    snapshot.flags = context;
+    snapshot.frame = usb_hw->sof_rd & USB_SOF_RD_BITS;
+}
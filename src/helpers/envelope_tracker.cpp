@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include "helpers/envelope_tracker.hpp"
+#include "definitions.hpp"
+
+void EnvelopeTracker::reset(uint16_t value)
+{
+    // Set the envelope to the value and start the decay from now on.
+    envelope = (uint32_t)value << 16;
+    consecutiveOutliers = 0;
+    lastDecay = millis();
+    initialized = true;
+}
+
+bool EnvelopeTracker::update(uint16_t value, uint16_t outlierThreshold)
+{
+    // If the tracker has not been initialized yet, start the envelope at the value.
+    if (!initialized)
+    {
+        reset(value);
+        return true;
+    }
+
+    // Check whether the value is beyond the envelope by more than the outlier threshold. If it is, reject it unless it persisted for
+    // long enough, in which case the signal actually changed (e.g. the key being pressed deeper) and the envelope jumps to it.
+    uint16_t current = get();
+    if ((trackMaximum && value > current + outlierThreshold) || (!trackMaximum && value + outlierThreshold < current))
+    {
+        if (++consecutiveOutliers < DRIFT_TRACKING_OUTLIER_SAMPLES)
+        {
+            rejected++;
+            return false;
+        }
+
+        reset(value);
+        return true;
+    }
+
+    consecutiveOutliers = 0;
+
+    // If the value is beyond the envelope, the envelope follows it immediately. This way the envelope represents the peaks of the signal.
+    if ((trackMaximum && value >= current) || (!trackMaximum && value <= current))
+    {
+        envelope = (uint32_t)value << 16;
+        lastDecay = millis();
+        return true;
+    }
+
+    // Otherwise let the envelope decay towards the value once per millisecond. This is done time-based rather than per value
+    // so that the speed of the decay does not depend on how often the key is being scanned. The amount of steps is capped
+    // since no values are passed while the signal is not being tracked, which should not be caught up on afterwards.
+    unsigned long now = millis();
+    uint32_t target = (uint32_t)value << 16;
+    for (uint8_t i = 0; i < 8 && now - lastDecay > i; i++)
+    {
+        if (trackMaximum)
+            envelope -= (envelope - target) >> DRIFT_TRACKING_DECAY_EXPONENT;
+        else
+            envelope += (target - envelope) >> DRIFT_TRACKING_DECAY_EXPONENT;
+    }
+    lastDecay = now;
+
+    return true;
+}
@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include "helpers/gauss_fitter.hpp"
+#include "helpers/noise_stats.hpp"
+#include "definitions.hpp"
+
+/*
+   Explanation of the Gauss Calibration
+
+   The gauss correction maps the ADC readings to a distance via the curve adc = A - B * e^(k * x), where x is the distance the key is
+   pressed down. This curve depends on the magnet, the sensor and the distance between them, so a single curve for all keys does not fit
+   every key equally well. The gauss calibration fits this curve to every key individually, based on a slow sweep over the full travel.
+
+   Recording: The ADC range between the rest and the down position is split into evenly spaced levels. While the key is being pressed
+   down slowly and steadily, the time at which the readings cross each level is recorded. Assuming a constant speed, the time at which
+   a level is crossed is proportional to the distance of that level. Returning to the rest position restarts the sweep.
+
+   Fitting: For a fixed curvature k, the curve is linear in A and B, so the best A and B follow from a linear least squares fit and the
+   quality of the fit is given by the correlation between the readings and e^(k * x). The curvature is found by evaluating a fixed range
+   of candidates, one per step, in fixed-point arithmetic to not stall the scans of the keys in between.
+*/
+
+void GaussFitter::begin(uint8_t keyIndex, uint16_t restPosition, uint16_t downPosition)
+{
+    this->keyIndex = keyIndex;
+    this->restPosition = restPosition;
+    this->downPosition = downPosition;
+    startTime = millis();
+    progress = 0;
+    state = GaussCalibrationState::Recording;
+}
+
+void GaussFitter::update(uint16_t value)
+{
+    // Abort the calibration if the sweep has not been completed in time.
+    if (millis() - startTime > GAUSS_CALIBRATION_TIMEOUT)
+    {
+        state = GaussCalibrationState::Failed;
+        return;
+    }
+
+    // If the key returned to the rest position, restart the sweep. This also discards crossings of the first level caused by noise at rest.
+    if (value > getLevel(0))
+        progress = 0;
+
+    // Record the time at which the readings crossed the next levels. Multiple levels may be crossed by a single reading.
+    uint32_t now = micros();
+    while (progress < GAUSS_CALIBRATION_LEVELS && value <= getLevel(progress))
+        positions[progress++] = now;
+
+    // If not all levels have been crossed yet, the sweep is still in progress.
+    if (progress < GAUSS_CALIBRATION_LEVELS)
+        return;
+
+    // Make sure that the sweep was slow enough, since the filter and the sample rate smear the crossings of a fast sweep.
+    uint32_t duration = positions[GAUSS_CALIBRATION_LEVELS - 1] - positions[0];
+    if (duration < GAUSS_CALIBRATION_MIN_SWEEP_TIME * 1000)
+    {
+        state = GaussCalibrationState::Failed;
+        return;
+    }
+
+    // Replace the times with the positions of the levels in the sweep, from 0 to 1 in Q16 fixed-point, and start fitting.
+    uint32_t start = positions[0];
+    for (uint32_t &position : positions)
+        position = ((uint64_t)(position - start) << 16) / duration;
+
+    progress = 0;
+    bestScore = 0;
+    bestCurvature = 0;
+    state = GaussCalibrationState::Fitting;
+}
+
+void GaussFitter::step()
+{
+    // Evaluate the next curvature candidate. The score is the negative covariance normalized by the standard deviation of e^(k * x),
+    // which is proportional to the correlation between the readings and e^(k * x), since the variance of the readings is the same for all
+    // candidates. The covariance is negative since the readings go down the further the key is pressed.
+    if (progress < GAUSS_FIT_CURVATURE_STEPS)
+    {
+        uint32_t curvature = (progress + 1) << 12;
+        int64_t covariance, variance, sumY, sumZ;
+        sum(curvature, covariance, variance, sumY, sumZ);
+
+        uint32_t deviation = NoiseStats::sqrt(variance);
+        int64_t score = deviation > 0 ? -covariance * 256 / deviation : 0;
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestCurvature = curvature;
+        }
+
+        progress++;
+        return;
+    }
+
+    // If no candidate correlates with the readings, the sweep did not resemble the curve.
+    if (bestCurvature == 0)
+    {
+        state = GaussCalibrationState::Failed;
+        return;
+    }
+
+    // Calculate A and B of the best candidate from the least squares fit. The curve is translated into the parameters of the gauss correction
+    // with no x-offset, where a = B and d = B - A. The curvature is converted from the sweep (0 to 1) to the travel distance in 0.01mm.
+    // Since the parameters of the gauss correction are based on 12-bit ADC counts, a and d are scaled down from the sensor resolution.
+    int64_t covariance, variance, sumY, sumZ;
+    sum(bestCurvature, covariance, variance, sumY, sumZ);
+    double slope = (double)covariance / variance;
+    double b = -slope * 65536;
+    double a = ((double)sumY - slope * sumZ) / GAUSS_CALIBRATION_LEVELS;
+    if (b <= 0)
+    {
+        state = GaussCalibrationState::Failed;
+        return;
+    }
+
+    double scale = 1 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION);
+    parameters = {b / scale, -(double)bestCurvature / 65536 / TRAVEL_DISTANCE_IN_0_01MM, 0, (b - a) / scale};
+    state = GaussCalibrationState::Done;
+}
+
+void GaussFitter::sum(uint32_t curvature, int64_t &covariance, int64_t &variance, int64_t &sumY, int64_t &sumZ)
+{
+    // Sum up the readings (the levels) and e^(k * x) at the positions they were crossed at. The covariance and variance are scaled by the
+    // amount of levels to stay in integer arithmetic. With a curvature of at most 5, e^(k * x) in Q16 fits into 24 bits and the readings into 16 bits, so this cannot overflow.
+    int64_t sumZZ = 0, sumYZ = 0;
+    sumY = 0;
+    sumZ = 0;
+    for (uint8_t i = 0; i < GAUSS_CALIBRATION_LEVELS; i++)
+    {
+        int64_t y = getLevel(i);
+        int64_t z = exp(((uint64_t)curvature * positions[i]) >> 16);
+        sumY += y;
+        sumZ += z;
+        sumZZ += z * z;
+        sumYZ += y * z;
+    }
+
+    covariance = GAUSS_CALIBRATION_LEVELS * sumYZ - sumY * sumZ;
+    variance = GAUSS_CALIBRATION_LEVELS * sumZZ - sumZ * sumZ;
+}
+
+uint16_t GaussFitter::getLevel(uint8_t index)
+{
+    return restPosition - (uint32_t)(restPosition - downPosition) * index / (GAUSS_CALIBRATION_LEVELS - 1);
+}
+
+uint32_t GaussFitter::exp(uint32_t x)
+{
+    // Calculate e^x as 2^(x * log2(e)). The integer part of the exponent is applied as a shift, the fractional part is approximated
+    // with a cubic polynomial that is exact at 0 and 1 and off by about 0.01% in between. log2(e) in Q16 fixed-point is 94548.
+    uint32_t y = ((uint64_t)x * 94548) >> 16;
+    uint64_t f = y & 0xFFFF;
+    uint64_t fraction = 65536 + ((f * (45581 + ((f * (14835 + ((f * 5120) >> 16))) >> 16))) >> 16);
+    return fraction << (y >> 16);
+}
@@ -2,22 +2,63 @@
 #include "helpers/gauss_lut.hpp"
 #include "definitions.hpp"
 
-GaussLUT::GaussLUT(double a, double b, double c, double d)
+void GaussLUT::build(const GaussParameters &parameters)
 {
+    // Start building the lookup table and calculate all of it at once.
+    setParameters(parameters);
+    while (!ready)
+        buildStep();
+}
+
+void GaussLUT::setParameters(const GaussParameters &parameters)
+{
+    // If the lookup table is already built or being built for the specified parameters, there is nothing to do.
+    if (this->parameters == parameters && (ready || buildIndex > 0))
+        return;
+
+    this->parameters = parameters;
+    ready = false;
+    buildIndex = 0;
+
+    // Calculate the "ideal" rest position of the LUT to calculate offsets on real-based rest positions later on.
+    // The parameters are based on 12-bit ADC counts, the rest position is scaled up to the sensor resolution.
+    lutRestPosition = (parameters.a * (1 - exp(-parameters.b * parameters.c)) - parameters.d) * (1 << (SENSOR_RESOLUTION - ANALOG_RESOLUTION));
+}
+
+void GaussLUT::buildStep()
+{
+    const double a = parameters.a;
+    const double b = parameters.b;
+    const double c = parameters.c;
+    const double d = parameters.d;
+
     // Fill the range from a to d in the LUT based on the parameters and the equation. (See:https://www.desmos.com/calculator/ps4wd127tu)
     // This calculates the "ideal" distance based on the relevant ADC range, being from a to d, since everything above a - d will equal to 0, anyways.
-    for (uint16_t i = 0; i < a - d; i++)
-            lut[i] = constrain(((log(1 - ((i + d) / a)) / -b) - c), 0, TRAVEL_DISTANCE_IN_0_01MM);
+    // Entries above that range are cleared since the table might have been built for different parameters before.
+    uint16_t end = min(buildIndex + GAUSS_LUT_BUILD_CHUNK_SIZE, 1 << ANALOG_RESOLUTION);
+    for (; buildIndex < end; buildIndex++)
+        lut[buildIndex] = buildIndex < a - d ? constrain(((log(1 - ((buildIndex + d) / a)) / -b) - c), 0, TRAVEL_DISTANCE_IN_0_01MM) : 0;
 
-    // Calculate the "ideal" rest position of the LUT to calculate offsets on real-based rest positions later on.
-    lutRestPosition = a * (1 - exp(-b * c)) - d;
+    // If the whole table has been calculated, it is ready to be used.
+    if (buildIndex == (1 << ANALOG_RESOLUTION))
+        ready = true;
 }
 
 uint16_t GaussLUT::adcToDistance(const uint16_t adc, const uint16_t restPosition)
 {
     // Get the offset by the difference between the "ideal" rest position of the LUT and the one of the sensor.
-    int16_t offset = lutRestPosition - restPosition;
+    int32_t offset = lutRestPosition - restPosition;
+
+    // Get the position of the adc value in the table, shifted by the offset determined above. The table has one entry per 12-bit ADC count,
+    // while the adc value has the sensor resolution, so the position is split into the index of the entry and the fraction to the next one.
+    constexpr uint8_t shift = SENSOR_RESOLUTION - ANALOG_RESOLUTION;
+    int32_t position = constrain(adc + offset, 0, ((1 << ANALOG_RESOLUTION) - 1) << shift);
+    uint16_t index = position >> shift;
+    int32_t fraction = position & ((1 << shift) - 1);
+
+    // Linearly interpolate between the entry and the next one, so that the finer steps of the sensor resolution are not lost.
+    if (fraction == 0)
+        return lut[index];
 
-    // Return the value at the index of the adc value, shifted by the offset determined above.
-    return lut[adc + offset];
+    return lut[index] + (((lut[index + 1] - lut[index]) * fraction) >> shift);
 }
@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include "helpers/latency_beacon.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "hardware/structs/usb.h"
+}
+
+void LatencyBeacon::add(char keyChar, bool pressed, uint32_t sampleTime, uint32_t queueTime)
+{
+    // Drop the record if there is no space left for the current report.
+    if (count == LATENCY_BEACON_CAPACITY)
+    {
+        dropped++;
+        return;
+    }
+
+    records[count++] = {keyChar, pressed, sampleTime, queueTime};
+}
+
+void LatencyBeacon::flush()
+{
+    if (count == 0)
+        return;
+
+    // The report has just been handed to the USB stack, which sends it on the next poll of the host. The number of the current USB frame
+    // is read from the last start-of-frame packet at this hand-off, so the report is picked up by the host in this frame or a later one.
+    uint32_t sendTime = micros();
+    uint16_t frame = usb_hw->sof_rd & USB_SOF_RD_BITS;
+
+    // Output the records in the format LAT <key char> <pressed> <sample time> <queue time> <send time> <handoff frame> <dropped>. This runs
+    // within the scans, so a record is only written if it fits into the buffer of the serial interface right away. Otherwise, e.g. if the
+    // host does not read the serial port, it is dropped instead of blocking the scans until the buffer has been drained.
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const LatencyRecord &record = records[i];
+        char line[LATENCY_RECORD_MAX_LENGTH];
+        int length = snprintf(line, sizeof(line), "LAT %d %d %lu %lu %lu %u %lu\n", (uint8_t)record.keyChar, record.pressed,
+                              (unsigned long)record.sampleTime, (unsigned long)record.queueTime, (unsigned long)sendTime, frame,
+                              (unsigned long)dropped);
+
+        if (Serial.availableForWrite() < length)
+        {
+            dropped += count - i;
+            break;
+        }
+
+        Serial.write(reinterpret_cast<const uint8_t *>(line), length);
+    }
+
+    count = 0;
+}
@@ -0,0 +1,45 @@
+#include <Arduino.h>
+#include "helpers/logger.hpp"
+#include "definitions.hpp"
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of two.");
+
+void Logger::push(const char *format, const uint32_t *arguments, uint32_t count)
+{
+    // Check whether the record fits into the free space of the ring buffer. The tail is loaded with acquire semantics, so the consumer
+    // is done reading the words it released before they are overwritten. If the record does not fit, it is dropped as a whole.
+    uint32_t position = head.load(std::memory_order_relaxed);
+    uint32_t size = count + 2;
+    if (LOG_BUFFER_SIZE - (position - tail.load(std::memory_order_acquire)) < size)
+    {
+        // Only the producer writes this counter, so a plain load and store is enough and avoids an atomic read-modify-write.
+        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Write the record, consisting of the address of the format string, the timestamp in microseconds and the arguments.
+    buffer[position++ & (LOG_BUFFER_SIZE - 1)] = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(format));
+    buffer[position++ & (LOG_BUFFER_SIZE - 1)] = micros();
+    for (uint32_t i = 0; i < count; i++)
+        buffer[position++ & (LOG_BUFFER_SIZE - 1)] = arguments[i];
+
+    // Publish the record with release semantics, so the consumer never sees the new head before the words of the record.
+    head.store(position, std::memory_order_release);
+}
+
+const uint32_t *Logger::peek(uint32_t &count)
+{
+    // Get the amount of words that can be read contiguously, up to the end of the ring buffer. Since the producer only ever publishes whole
+    // records, the words between the tail and the head always consist of whole records, but they may wrap around the end of the buffer.
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    uint32_t available = head.load(std::memory_order_acquire) - position;
+    uint32_t offset = position & (LOG_BUFFER_SIZE - 1);
+    count = min(available, LOG_BUFFER_SIZE - offset);
+    return buffer + offset;
+}
+
+void Logger::consume(uint32_t count)
+{
+    // Release the specified amount of read words back to the producer.
+    tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
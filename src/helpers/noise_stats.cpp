@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include "helpers/noise_stats.hpp"
+
+void NoiseStats::add(uint16_t value)
+{
+    // Update the running mean and the sum of squared differences using Welford's online algorithm. The mean is kept
+    // in Q8 fixed-point to not lose the fractional part, which would otherwise bias the variance of low-noise signals.
+    int32_t x = (int32_t)value << 8;
+    count++;
+    int32_t delta = x - runningMean;
+
+    // Round the division to the nearest value instead of towards zero, which would let the mean drift low over the window.
+    runningMean += (delta + (delta >= 0 ? count / 2 : -(count / 2))) / count;
+    m2 += (int64_t)delta * (x - runningMean);
+
+    // Keep track of the lowest and highest value for the peak-to-peak range.
+    if (value < lowest)
+        lowest = value;
+    if (value > highest)
+        highest = value;
+
+    // If the window is not full yet, there is nothing to publish.
+    if (count < (1 << NOISE_STATS_WINDOW_EXPONENT))
+        return;
+
+    // Publish the results of the window. The variance is in Q16, therefore the square root of it is in Q8.
+    mean = (runningMean + (1 << 7)) >> 8;
+    standardDeviation = sqrt(m2 / (count - 1));
+    peakToPeak = highest - lowest;
+    valid = true;
+
+    // Start a new window.
+    discard();
+}
+
+void NoiseStats::discard()
+{
+    // Reset the state of the current window. The results of the last completed window are kept.
+    count = 0;
+    runningMean = 0;
+    m2 = 0;
+    lowest = UINT16_MAX;
+    highest = 0;
+}
+
+uint32_t NoiseStats::sqrt(uint64_t value)
+{
+    // Calculate the square root bit by bit, starting with the highest power of 4 not bigger than the value.
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+            result >>= 1;
+
+        bit >>= 2;
+    }
+
+    return result;
+}
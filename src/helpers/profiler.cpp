@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include "helpers/profiler.hpp"
+#include "definitions.hpp"
+
+#if DEV
+
+extern "C"
+{
+#include "hardware/timer.h"
+#include "hardware/irq.h"
+}
+
+// Called by the interrupt handler below with the program counter that was interrupted.
+extern "C" void profilerSample(uint32_t pc)
+{
+    Profiler.sample(pc);
+}
+
+// The interrupt handler of the hardware alarm. On exception entry, the Cortex-M0+ pushes R0-R3, R12, LR, PC and xPSR onto the stack that was
+// active, which is the process stack if bit 2 of the EXC_RETURN value in LR is set and the main stack otherwise. The interrupted PC is read from
+// offset 24 of that frame and passed to profilerSample() via a tail call, so that its return performs the exception return with the original LR.
+extern "C" __attribute__((naked)) void profilerIRQHandler()
+{
+    __asm volatile(
+        "movs r0, #4\n"
+        "mov r1, lr\n"
+        "tst r0, r1\n"
+        "beq 1f\n"
+        "mrs r0, psp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, msp\n"
+        "2:\n"
+        "ldr r0, [r0, #24]\n"
+        "ldr r1, =profilerSample\n"
+        "bx r1\n"
+        ".align 2\n"
+        ".ltorg\n");
+}
+
+void Profiler::start(uint32_t interval)
+{
+    // Make sure the interval leaves enough time between two samples for the firmware to make progress.
+    if (interval < PROFILER_MIN_INTERVAL_US)
+        return;
+
+    // Claim a hardware alarm that is not used by the core yet and install the handler above as the exclusive handler of its interrupt.
+    // The SDK alarm functions are not used since their shared handler would hide the interrupted program counter.
+    if (alarm < 0)
+    {
+        alarm = hardware_alarm_claim_unused(false);
+        if (alarm < 0)
+            return;
+
+        irq_set_exclusive_handler(TIMER_IRQ_0 + alarm, profilerIRQHandler);
+    }
+
+    // Arm the alarm for the first sample and enable its interrupt.
+    this->interval = interval;
+    running = true;
+    hw_set_bits(&timer_hw->inte, 1u << alarm);
+    irq_set_enabled(TIMER_IRQ_0 + alarm, true);
+    timer_hw->alarm[alarm] = timer_hw->timerawl + interval;
+}
+
+void Profiler::stop()
+{
+    // Disable the interrupt of the alarm. The alarm itself stays claimed for the next start.
+    if (alarm < 0)
+        return;
+
+    irq_set_enabled(TIMER_IRQ_0 + alarm, false);
+    hw_clear_bits(&timer_hw->inte, 1u << alarm);
+    running = false;
+}
+
+void Profiler::reset()
+{
+    // Clear the histogram and the counters. The interrupt is disabled meanwhile so it does not write into a half-cleared table.
+    bool wasRunning = running;
+    stop();
+    for (ProfilerBucket &bucket : buckets)
+        bucket = {0, 0};
+    samples = 0;
+    dropped = 0;
+    if (wasRunning)
+        start(interval);
+}
+
+void Profiler::sample(uint32_t pc)
+{
+    // Acknowledge the interrupt and arm the alarm for the next sample.
+    hw_clear_bits(&timer_hw->intr, 1u << alarm);
+    timer_hw->alarm[alarm] = timer_hw->timerawl + interval;
+    samples++;
+
+    // Find the bucket of the address via linear probing, starting at the multiplicative hash of it. This is bounded by the size of the
+    // table, so a full table costs a few microseconds per sample at worst, dropping the sample.
+    uint32_t address = pc & ~(PROFILER_BUCKET_SIZE - 1);
+    uint32_t mask = (1 << PROFILER_BUCKETS_EXPONENT) - 1;
+    uint32_t index = (address * 2654435761u) >> (32 - PROFILER_BUCKETS_EXPONENT);
+    for (uint32_t i = 0; i <= mask; i++, index = (index + 1) & mask)
+    {
+        ProfilerBucket &bucket = buckets[index];
+        if (bucket.address == address || bucket.address == 0)
+        {
+            bucket.address = address;
+            bucket.count++;
+            return;
+        }
+    }
+
+    dropped++;
+}
+
+#endif
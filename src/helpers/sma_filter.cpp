@@ -20,3 +20,14 @@ uint16_t SMAFilter::operator()(uint16_t value)
     // Divide the number by the amount of samples using bitshifting and return it.
     return sum >> samplesExponent;
 }
+
+void SMAFilter::fill(uint16_t value)
+{
+    // Overwrite every element of the buffer with the value and set the sum accordingly. The filter is fully initialized afterwards.
+    for (uint8_t i = 0; i < samples; i++)
+        buffer[i] = value;
+
+    sum = (uint32_t)value << samplesExponent;
+    index = 0;
+    initialized = true;
+}
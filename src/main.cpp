@@ -2,15 +2,21 @@
 #include <EEPROM.h>
 #include <Keyboard.h>
 #include "config/configuration_controller.hpp"
+#include "config/statistics_controller.hpp"
 #include "handlers/serial_handler.hpp"
 #include "handlers/key_handler.hpp"
+#include "handlers/idle_handler.hpp"
+#include "handlers/gamepad_handler.hpp"
+#include "helpers/deadline_monitor.hpp"
+#include "boards/boards.hpp"
 #include "definitions.hpp"
 
 void setup()
 {
-    // Initialize the EEPROM with 1024 bytes and load the configuration from it.
-    EEPROM.begin(1024);
+    // Initialize the EEPROM and load the configuration and statistics from it.
+    EEPROM.begin(EEPROM_SIZE);
     ConfigController.loadConfig();
+    StatisticsController.loadStatistics();
 
     // Initialize the serial and HID interface.
     Serial.begin(115200);
@@ -20,18 +26,45 @@ void setup()
     // Set the amount of bits for the ADC to the defined one for a better resolution on the analog readings.
     analogReadResolution(ANALOG_RESOLUTION);
 
+    // Select the variant of the board the firmware is running on and set up the key handler for it.
+    KeyHandler.begin(selectBoard());
+
+    // Initialize the gamepad interface, which sends the travel distance of the keys as axes if enabled.
+    GamepadHandler.begin();
+
     // Allows to boot into UF2 bootloader mode by pressing the reset button twice.
     rp2040.enableDoubleResetBootloader();
 }
 
 void loop()
 {
+    // Measure the previous iteration against the loop deadline and start measuring this one.
+    DeadlineMonitor.beginIteration();
+
     // Run the keypad handler checks to handle the actual keypad functionality.
     KeyHandler.handle();
+    DeadlineMonitor.mark(LoopStage::Keys);
+
+    // Send the travel distance of the keys as gamepad axes, if enabled.
+    GamepadHandler.handle();
+    DeadlineMonitor.mark(LoopStage::Gamepad);
+
+    // Pass the motion state to the idle handler, which slows down the scans if the keypad has been idle for long enough.
+    // The sleep between two scans while idle is intentional, so it is not counted towards the loop deadline.
+    IdleHandler.handle(KeyHandler.motionDetected);
+    DeadlineMonitor.mark(LoopStage::Idle, IdleHandler.idle);
+
+    // Checkpoint the statistics of the keys to the EEPROM from time to time, while the keypad is idle or at least not in use.
+    StatisticsController.handle(IdleHandler.isQuiet());
+    DeadlineMonitor.mark(LoopStage::Statistics);
 }
 
 void serialEvent()
 {
+    // The time since the end of the loop was spent in the core, the handling of the serial input is measured separately.
+    DeadlineMonitor.mark(LoopStage::Core);
+    DeadlineMonitor.flag(DeadlineFlag::SerialCommand);
+
     // Handle incoming serial data.
     while(Serial.available() > 0)
     {
@@ -43,4 +76,6 @@ void serialEvent()
         // Pass the read input to the serial handler to handle it.
         SerialHandler.handleSerialInput(input);
     }
+
+    DeadlineMonitor.mark(LoopStage::SerialInput);
 }